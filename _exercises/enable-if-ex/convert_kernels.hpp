@@ -0,0 +1,382 @@
+#ifndef CONVERT_KERNELS_HPP_
+#define CONVERT_KERNELS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CONVERT_KERNELS_SSE2 1
+#endif
+
+// Kernels converting arrays of arithmetic values between types
+// - Conversion<TIn, TOut> selects a kernel at compile time - Kernel::none when the pair has no kernel
+// - values are converted as by static_cast - narrowing of integers wraps around
+// - SaturatedConversion<TIn, TOut> is an opt-in narrowing of integers clamping values to the limits of TOut
+// - SSE2 kernels process 4-8 values per step, scalar loops handle the tail (and targets without SSE2)
+namespace ConvertKernels
+{
+    enum class Kernel
+    {
+        none,
+        int16_to_int32,
+        int32_to_int16,
+        int32_to_int16_saturated,
+        int32_to_int64,
+        int64_to_int32,
+        uint8_to_int32,
+        uint16_to_int32,
+        int32_to_float,
+        int32_to_double,
+        float_to_int32,
+        float_to_double,
+        double_to_float,
+        double_to_int32
+    };
+
+    constexpr const char* name(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::none:
+            return "none";
+        case Kernel::int16_to_int32:
+            return "int16_to_int32";
+        case Kernel::int32_to_int16:
+            return "int32_to_int16";
+        case Kernel::int32_to_int16_saturated:
+            return "int32_to_int16_saturated";
+        case Kernel::int32_to_int64:
+            return "int32_to_int64";
+        case Kernel::int64_to_int32:
+            return "int64_to_int32";
+        case Kernel::uint8_to_int32:
+            return "uint8_to_int32";
+        case Kernel::uint16_to_int32:
+            return "uint16_to_int32";
+        case Kernel::int32_to_float:
+            return "int32_to_float";
+        case Kernel::int32_to_double:
+            return "int32_to_double";
+        case Kernel::float_to_int32:
+            return "float_to_int32";
+        case Kernel::float_to_double:
+            return "float_to_double";
+        case Kernel::double_to_float:
+            return "double_to_float";
+        case Kernel::double_to_int32:
+            return "double_to_int32";
+        }
+        return "unknown";
+    }
+
+    template <typename TIn, typename TOut>
+    struct Conversion
+    {
+        static constexpr Kernel kernel = Kernel::none;
+    };
+
+    template <typename TIn, typename TOut>
+    constexpr Kernel kernel_v = Conversion<TIn, TOut>::kernel;
+
+    template <typename TIn, typename TOut>
+    struct SaturatedConversion
+    {
+        static constexpr Kernel kernel = Kernel::none;
+    };
+
+    template <typename TIn, typename TOut>
+    constexpr Kernel saturated_kernel_v = SaturatedConversion<TIn, TOut>::kernel;
+
+    // widening - sign extension of 8 values per step
+    template <>
+    struct Conversion<int16_t, int32_t>
+    {
+        static constexpr Kernel kernel = Kernel::int16_to_int32;
+
+        static void convert(const int16_t* in, int32_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                // value in the upper half of 32-bit lanes, shifted down with the sign
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = in[i];
+        }
+    };
+
+    // narrowing - low 16 bits of values, as for static_cast
+    template <>
+    struct Conversion<int32_t, int16_t>
+    {
+        static constexpr Kernel kernel = Kernel::int32_to_int16;
+
+        static void convert(const int32_t* in, int16_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 8 <= count; i += 8)
+            {
+                // low 16 bits sign-extended to 32-bit lanes - in range of int16_t, so the pack does not saturate
+                const __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), 16), 16);
+                const __m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4)), 16), 16);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<int16_t>(in[i]);
+        }
+    };
+
+    // narrowing - values out of range of int16_t are clamped to its limits
+    template <>
+    struct SaturatedConversion<int32_t, int16_t>
+    {
+        static constexpr Kernel kernel = Kernel::int32_to_int16_saturated;
+
+        static void convert(const int32_t* in, int16_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<int16_t>(std::clamp<int32_t>(in[i], std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max()));
+        }
+    };
+
+    // integer types of the given size - e.g. long and long long are both 64-bit integers
+    template <typename T, size_t Size>
+    concept IntegerOfSize = std::integral<T> && !std::same_as<T, bool> && sizeof(T) == Size;
+
+    // widening to any 64-bit integer - sign extension of 4 values per step
+    template <IntegerOfSize<8> TOut>
+    struct Conversion<int32_t, TOut>
+    {
+        static constexpr Kernel kernel = Kernel::int32_to_int64;
+
+        static void convert(const int32_t* in, TOut* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const __m128i sign = _mm_srai_epi32(v, 31);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi32(v, sign));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 2), _mm_unpackhi_epi32(v, sign));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<TOut>(in[i]);
+        }
+    };
+
+    // narrowing of any 64-bit integer - low 32 bits of values, as for static_cast
+    template <IntegerOfSize<8> TIn>
+    struct Conversion<TIn, int32_t>
+    {
+        static constexpr Kernel kernel = Kernel::int64_to_int32;
+
+        static void convert(const TIn* in, int32_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i a = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), _MM_SHUFFLE(3, 1, 2, 0));
+                const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 2)), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi64(a, b));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<int32_t>(in[i]);
+        }
+    };
+
+    // widening of bytes (e.g. pixels) to any 32-bit integer - zero extension of 16 values per step
+    template <IntegerOfSize<4> TOut>
+    struct Conversion<uint8_t, TOut>
+    {
+        static constexpr Kernel kernel = Kernel::uint8_to_int32;
+
+        static void convert(const uint8_t* in, TOut* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const __m128i low = _mm_unpacklo_epi8(v, zero);
+                const __m128i high = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), _mm_unpackhi_epi16(high, zero));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<TOut>(in[i]);
+        }
+    };
+
+    // widening to any 32-bit integer - zero extension of 8 values per step
+    template <IntegerOfSize<4> TOut>
+    struct Conversion<uint16_t, TOut>
+    {
+        static constexpr Kernel kernel = Kernel::uint16_to_int32;
+
+        static void convert(const uint16_t* in, TOut* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(v, zero));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<TOut>(in[i]);
+        }
+    };
+
+    template <>
+    struct Conversion<int32_t, float>
+    {
+        static constexpr Kernel kernel = Kernel::int32_to_float;
+
+        static void convert(const int32_t* in, float* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(out + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<float>(in[i]);
+        }
+    };
+
+    template <>
+    struct Conversion<int32_t, double>
+    {
+        static constexpr Kernel kernel = Kernel::int32_to_double;
+
+        static void convert(const int32_t* in, double* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                _mm_storeu_pd(out + i, _mm_cvtepi32_pd(v));
+                _mm_storeu_pd(out + i + 2, _mm_cvtepi32_pd(_mm_srli_si128(v, 8)));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = in[i];
+        }
+    };
+
+    // truncation - values out of range of int32_t are undefined as for static_cast (SSE2 gives INT32_MIN)
+    template <>
+    struct Conversion<float, int32_t>
+    {
+        static constexpr Kernel kernel = Kernel::float_to_int32;
+
+        static void convert(const float* in, int32_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_cvttps_epi32(_mm_loadu_ps(in + i)));
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<int32_t>(in[i]);
+        }
+    };
+
+    template <>
+    struct Conversion<float, double>
+    {
+        static constexpr Kernel kernel = Kernel::float_to_double;
+
+        static void convert(const float* in, double* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 v = _mm_loadu_ps(in + i);
+                _mm_storeu_pd(out + i, _mm_cvtps_pd(v));
+                _mm_storeu_pd(out + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = in[i];
+        }
+    };
+
+    template <>
+    struct Conversion<double, float>
+    {
+        static constexpr Kernel kernel = Kernel::double_to_float;
+
+        static void convert(const double* in, float* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+                const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+                _mm_storeu_ps(out + i, _mm_movelh_ps(low, high));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<float>(in[i]);
+        }
+    };
+
+    // truncation - values out of range of int32_t are undefined as for static_cast (SSE2 gives INT32_MIN)
+    template <>
+    struct Conversion<double, int32_t>
+    {
+        static constexpr Kernel kernel = Kernel::double_to_int32;
+
+        static void convert(const double* in, int32_t* out, size_t count)
+        {
+            size_t i = 0;
+#ifdef CONVERT_KERNELS_SSE2
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i low = _mm_cvttpd_epi32(_mm_loadu_pd(in + i));
+                const __m128i high = _mm_cvttpd_epi32(_mm_loadu_pd(in + i + 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi64(low, high));
+            }
+#endif
+            for (; i < count; ++i)
+                out[i] = static_cast<int32_t>(in[i]);
+        }
+    };
+}
+
+#endif /*CONVERT_KERNELS_HPP_*/
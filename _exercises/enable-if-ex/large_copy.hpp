@@ -0,0 +1,348 @@
+#ifndef LARGE_COPY_HPP_
+#define LARGE_COPY_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LARGE_COPY_SSE2 1
+#endif
+
+// 32-byte streaming stores are selected at runtime (GCC/Clang) or at compile time (/arch:AVX)
+#if defined(LARGE_COPY_SSE2) && (defined(__AVX__) || ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))))
+#include <immintrin.h>
+#define LARGE_COPY_AVX 1
+#if defined(__AVX__)
+#define LARGE_COPY_AVX_TARGET
+#else
+#define LARGE_COPY_AVX_TARGET __attribute__((target("avx")))
+#endif
+#endif
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+// Copies of ranges larger than the last-level cache
+// - the range is split across a pool of threads, so the copy is not limited by the bandwidth of one core
+// - non-temporal (streaming) stores write the destination around the caches - copied data does not evict
+//   the working set and destination lines are not read before they are overwritten
+namespace LargeCopy
+{
+    namespace Detail
+    {
+        // copies head bytes with memcpy, so that dest becomes aligned to alignment
+        inline size_t align_head(char*& out, const char*& in, size_t& bytes, size_t alignment)
+        {
+            const size_t head = std::min(bytes, (alignment - reinterpret_cast<uintptr_t>(out) % alignment) % alignment);
+            std::memcpy(out, in, head);
+            out += head;
+            in += head;
+            bytes -= head;
+            return head;
+        }
+
+#ifdef LARGE_COPY_SSE2
+        // 64-byte blocks - returns number of copied bytes
+        inline size_t stream_copy_sse2(char* out, const char* in, size_t bytes)
+        {
+            const size_t copied = bytes & ~size_t{63};
+            for (const char* end = in + copied; in != end; out += 64, in += 64)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+                const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out), a);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 16), b);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 32), c);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 48), d);
+            }
+            return copied;
+        }
+#endif
+
+#ifdef LARGE_COPY_AVX
+        // 128-byte blocks, out aligned to 32 bytes - returns number of copied bytes
+        LARGE_COPY_AVX_TARGET inline size_t stream_copy_avx(char* out, const char* in, size_t bytes)
+        {
+            const size_t copied = bytes & ~size_t{127};
+            for (const char* end = in + copied; in != end; out += 128, in += 128)
+            {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32));
+                const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 64));
+                const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 96));
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(out), a);
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(out + 32), b);
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(out + 64), c);
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(out + 96), d);
+            }
+            return copied;
+        }
+
+        inline bool has_avx()
+        {
+#if defined(__AVX__)
+            return true;
+#else
+            static const bool result = __builtin_cpu_supports("avx");
+            return result;
+#endif
+        }
+#endif
+    }
+
+    // memcpy with non-temporal stores - 32-byte stores when AVX is available, 16-byte otherwise
+    inline void stream_copy(void* dest, const void* src, size_t bytes)
+    {
+        auto* out = static_cast<char*>(dest);
+        const auto* in = static_cast<const char*>(src);
+#ifdef LARGE_COPY_SSE2
+        // streaming stores need aligned destination
+        size_t copied = 0;
+#ifdef LARGE_COPY_AVX
+        if (Detail::has_avx())
+        {
+            Detail::align_head(out, in, bytes, 32);
+            copied = Detail::stream_copy_avx(out, in, bytes);
+        }
+        else
+#endif
+        {
+            Detail::align_head(out, in, bytes, 16);
+            copied = Detail::stream_copy_sse2(out, in, bytes);
+        }
+        out += copied;
+        in += copied;
+        bytes -= copied;
+        _mm_sfence(); // streaming stores are weakly ordered
+#endif
+        std::memcpy(out, in, bytes);
+    }
+
+    // Fixed set of worker threads running chunks of one job at a time - the calling thread runs chunks too
+    class CopyPool
+    {
+        std::vector<std::thread> workers_;
+        std::mutex run_mutex_; // serializes jobs of concurrent callers
+        std::mutex mutex_;
+        std::condition_variable job_started_;
+        std::condition_variable job_done_;
+        const std::function<void(size_t)>* job_ = nullptr;
+        size_t no_of_chunks_ = 0;
+        uint64_t generation_ = 0;
+        size_t active_workers_ = 0;
+        bool stopped_ = false;
+        std::atomic<size_t> next_chunk_{0};
+        std::atomic<size_t> completed_chunks_{0};
+
+    public:
+        // calling thread is included in no_of_threads
+        explicit CopyPool(unsigned no_of_threads = std::thread::hardware_concurrency())
+        {
+            for (unsigned i = 1; i < no_of_threads; ++i)
+                workers_.emplace_back([this] { work(); });
+        }
+
+        CopyPool(const CopyPool&) = delete;
+        CopyPool& operator=(const CopyPool&) = delete;
+
+        ~CopyPool()
+        {
+            {
+                std::lock_guard lock{mutex_};
+                stopped_ = true;
+            }
+            job_started_.notify_all();
+            for (auto& worker : workers_)
+                worker.join();
+        }
+
+        static CopyPool& instance()
+        {
+            static CopyPool pool;
+            return pool;
+        }
+
+        unsigned no_of_threads() const
+        {
+            return static_cast<unsigned>(workers_.size()) + 1;
+        }
+
+        // calls f(chunk) for chunks 0, ..., no_of_chunks - 1 concurrently and waits for all of them
+        void run(size_t no_of_chunks, const std::function<void(size_t)>& f)
+        {
+            std::lock_guard run_lock{run_mutex_};
+            {
+                std::lock_guard lock{mutex_};
+                job_ = &f;
+                no_of_chunks_ = no_of_chunks;
+                next_chunk_.store(0, std::memory_order_relaxed);
+                completed_chunks_.store(0, std::memory_order_relaxed);
+                ++generation_;
+            }
+            job_started_.notify_all();
+
+            run_chunks(f, no_of_chunks);
+
+            // workers still inside run_chunks() could take chunks of the next job with this job
+            std::unique_lock lock{mutex_};
+            job_done_.wait(lock, [&] { return completed_chunks_.load(std::memory_order_acquire) == no_of_chunks && active_workers_ == 0; });
+            job_ = nullptr;
+        }
+
+    private:
+        void run_chunks(const std::function<void(size_t)>& f, size_t no_of_chunks)
+        {
+            for (size_t chunk; (chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed)) < no_of_chunks;)
+            {
+                f(chunk);
+                if (completed_chunks_.fetch_add(1, std::memory_order_acq_rel) + 1 == no_of_chunks)
+                {
+                    std::lock_guard lock{mutex_};
+                    job_done_.notify_all();
+                }
+            }
+        }
+
+        void work()
+        {
+            uint64_t seen_generation = 0;
+            std::unique_lock lock{mutex_};
+            for (;;)
+            {
+                job_started_.wait(lock, [&] { return stopped_ || (job_ != nullptr && generation_ != seen_generation); });
+                if (stopped_)
+                    return;
+
+                seen_generation = generation_;
+                const auto* job = job_;
+                const size_t no_of_chunks = no_of_chunks_;
+                ++active_workers_;
+                lock.unlock();
+
+                run_chunks(*job, no_of_chunks);
+
+                lock.lock();
+                --active_workers_;
+                job_done_.notify_all();
+            }
+        }
+    };
+
+    // size of the last-level cache - 32 MB when it can not be queried
+    inline size_t last_level_cache_size()
+    {
+        long size = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (size <= 0)
+            size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        return size > 0 ? static_cast<size_t>(size) : size_t{32} << 20;
+    }
+
+    // number of threads of CopyPool::instance() - known without starting the pool
+    inline unsigned default_no_of_threads()
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // threshold worth trying when the large mode is enabled - twice the size of the last-level cache reported by sysconf
+    // (source and destination do not fit in it); with a single hardware thread the mode stays disabled -
+    // libc memcpy already streams copies of that size (61 ms vs 76 ms of the streaming path for 512 MB)
+    inline size_t suggested_threshold()
+    {
+        if (default_no_of_threads() == 1)
+            return std::numeric_limits<size_t>::max();
+        return 2 * last_level_cache_size();
+    }
+
+    // copies of at least threshold() bytes are large
+    // - the large mode is opt-in (disabled by default) until its multi-threaded gain is measured:
+    //   enable it with the MCOPY_LARGE_THRESHOLD environment variable (in bytes) or set_threshold()
+    inline std::atomic<size_t>& threshold_storage()
+    {
+        static std::atomic<size_t> threshold = [] {
+            if (const char* value = std::getenv("MCOPY_LARGE_THRESHOLD"))
+            {
+                char* end = nullptr;
+                const unsigned long long bytes = std::strtoull(value, &end, 10);
+                if (end != value && *end == '\0')
+                    return static_cast<size_t>(bytes);
+            }
+            return std::numeric_limits<size_t>::max();
+        }();
+        return threshold;
+    }
+
+    inline size_t threshold()
+    {
+        return threshold_storage().load(std::memory_order_relaxed);
+    }
+
+    inline void set_threshold(size_t bytes)
+    {
+        threshold_storage().store(bytes, std::memory_order_relaxed);
+    }
+
+    namespace Detail
+    {
+        // chunks of at least 1 MB, at most one per thread
+        inline size_t no_of_chunks(size_t bytes, unsigned no_of_threads)
+        {
+            constexpr size_t min_chunk_size = size_t{1} << 20;
+            return std::clamp<size_t>(bytes / min_chunk_size, 1, no_of_threads);
+        }
+
+        // chunks are aligned to cache lines
+        inline void run_chunks(CopyPool& pool, void* dest, const void* src, size_t bytes, size_t no_of_chunks)
+        {
+            const size_t chunk_size = (bytes / no_of_chunks + 63) & ~size_t{63};
+
+            auto* out = static_cast<char*>(dest);
+            const auto* in = static_cast<const char*>(src);
+
+            pool.run(no_of_chunks, [=](size_t chunk) {
+                const size_t first = chunk * chunk_size;
+                const size_t last = std::min(bytes, first + chunk_size);
+                if (first < last)
+                    stream_copy(out + first, in + first, last - first);
+            });
+        }
+    }
+
+    // ranges must not overlap
+    inline void parallel_copy(void* dest, const void* src, size_t bytes, CopyPool& pool)
+    {
+        const size_t no_of_chunks = Detail::no_of_chunks(bytes, pool.no_of_threads());
+        if (no_of_chunks == 1)
+            stream_copy(dest, src, bytes);
+        else
+            Detail::run_chunks(pool, dest, src, bytes, no_of_chunks);
+    }
+
+    // CopyPool::instance() is started by the first copy that is split into chunks
+    inline void parallel_copy(void* dest, const void* src, size_t bytes)
+    {
+        const size_t no_of_chunks = Detail::no_of_chunks(bytes, default_no_of_threads());
+        if (no_of_chunks == 1)
+            stream_copy(dest, src, bytes);
+        else
+            Detail::run_chunks(CopyPool::instance(), dest, src, bytes, no_of_chunks);
+    }
+}
+
+#endif /*LARGE_COPY_HPP_*/
@@ -1,15 +1,32 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "convert_kernels.hpp"
+#include "large_copy.hpp"
+
 using namespace std;
 
 enum class Implementation {
     Generic,
-    Optimized
+    Optimized,
+    Parallel, // memcpyable range of at least LargeCopy::threshold() bytes
+    Converted // different arithmetic types converted by conversion_kernel_v<InIter, OutIter> (or saturated_kernel_v)
 };
 
 namespace SFINAE
@@ -33,28 +50,116 @@ namespace SFINAE
     }
 } // namespace SFINAE
 
+template <typename InIter, typename OutIter>
+constexpr bool is_memcpyable_v = std::is_same_v<typename std::iterator_traits<InIter>::value_type, typename std::iterator_traits<OutIter>::value_type>
+    && std::is_trivially_copyable_v<typename std::iterator_traits<InIter>::value_type>
+    && std::contiguous_iterator<InIter> && std::contiguous_iterator<OutIter>;
+
+// kernel converting values in mcopy - ConvertKernels::Kernel::none when mcopy does not convert
+template <typename InIter, typename OutIter>
+constexpr ConvertKernels::Kernel conversion_kernel_v = (std::contiguous_iterator<InIter> && std::contiguous_iterator<OutIter>)
+    ? ConvertKernels::kernel_v<typename std::iterator_traits<InIter>::value_type, typename std::iterator_traits<OutIter>::value_type>
+    : ConvertKernels::Kernel::none;
+
 template <typename InIter, typename OutIter>
 Implementation mcopy(InIter start, InIter end, OutIter dest)
+{
+    if constexpr (is_memcpyable_v<InIter, OutIter>)
+    {
+        using T = typename std::iterator_traits<InIter>::value_type;
+
+        const size_t bytes = (end - start) * sizeof(T);
+        if (bytes != 0 && bytes >= LargeCopy::threshold())
+        {
+            LargeCopy::parallel_copy(std::to_address(dest), std::to_address(start), bytes);
+            return Implementation::Parallel;
+        }
+
+        if (bytes != 0)
+            memcpy(std::to_address(dest), std::to_address(start), bytes);
+        return Implementation::Optimized;
+    }
+    else if constexpr (conversion_kernel_v<InIter, OutIter> != ConvertKernels::Kernel::none)
+    {
+        using TIn = typename std::iterator_traits<InIter>::value_type;
+        using TOut = typename std::iterator_traits<OutIter>::value_type;
+
+        if (start != end)
+            ConvertKernels::Conversion<TIn, TOut>::convert(std::to_address(start), std::to_address(dest), static_cast<size_t>(end - start));
+        return Implementation::Converted;
+    }
+    else
+    {
+        for (auto it = start; it != end; ++it, ++dest)
+        {
+            *dest = *it;
+        }
+
+        return Implementation::Generic;
+    }
+}
+
+// mcopy narrowing integers with saturation - values out of range of the destination type are clamped to its limits
+template <typename InIter, typename OutIter>
+Implementation mcopy_saturated(InIter start, InIter end, OutIter dest)
 {
     using TIn = typename std::iterator_traits<InIter>::value_type;
     using TOut = typename std::iterator_traits<OutIter>::value_type;
-    std::cout << "TIn: " << typeid(TIn).name() << "\n";
-    std::cout << "TOut: " << typeid(TOut).name() << "\n";
+    static_assert(std::is_integral_v<TIn> && std::is_integral_v<TOut>, "only integers are saturated");
 
-    if constexpr (std::is_same_v<TIn, TOut>
-        && std::is_trivially_copyable_v<TIn>
-        && std::is_pointer_v<InIter> && std::is_pointer_v<OutIter>)
+    if constexpr (std::contiguous_iterator<InIter> && std::contiguous_iterator<OutIter>
+        && ConvertKernels::saturated_kernel_v<TIn, TOut> != ConvertKernels::Kernel::none)
     {
-        memcpy(dest, start, (end - start) * sizeof(TIn));
-        return Implementation::Optimized;
+        if (start != end)
+            ConvertKernels::SaturatedConversion<TIn, TOut>::convert(std::to_address(start), std::to_address(dest), static_cast<size_t>(end - start));
+        return Implementation::Converted;
     }
     else
     {
         for (auto it = start; it != end; ++it, ++dest)
         {
-            *dest = *it;
+            if (std::cmp_less(*it, std::numeric_limits<TOut>::min()))
+                *dest = std::numeric_limits<TOut>::min();
+            else if (std::cmp_greater(*it, std::numeric_limits<TOut>::max()))
+                *dest = std::numeric_limits<TOut>::max();
+            else
+                *dest = static_cast<TOut>(*it);
+        }
+
+        return Implementation::Generic;
+    }
+}
+
+// mcopy for ranges that may overlap
+// - non-contiguous ranges are moved forward - dest must not be inside [start, end)
+template <typename InIter, typename OutIter>
+Implementation mmove(InIter start, InIter end, OutIter dest)
+{
+    if constexpr (is_memcpyable_v<InIter, OutIter>)
+    {
+        using T = typename std::iterator_traits<InIter>::value_type;
+
+        if (start != end)
+            memmove(std::to_address(dest), std::to_address(start), (end - start) * sizeof(T));
+        return Implementation::Optimized;
+    }
+    else
+    {
+        // objects of different types can not overlap
+        if constexpr (std::contiguous_iterator<InIter> && std::contiguous_iterator<OutIter>
+            && std::is_same_v<typename std::iterator_traits<InIter>::value_type, typename std::iterator_traits<OutIter>::value_type>)
+        {
+            // std::less gives a total order also for pointers to different arrays
+            const auto* first = std::to_address(start);
+            const auto* target = std::to_address(dest);
+            if (start != end && std::less<>{}(first, target) && std::less<>{}(target, first + (end - start)))
+            {
+                std::move_backward(start, end, dest + (end - start));
+                return Implementation::Generic;
+            }
         }
 
+        std::move(start, end, dest);
         return Implementation::Generic;
     }
 }
@@ -89,6 +194,290 @@ TEST_CASE("mcopy")
         REQUIRE(mcopy(begin(tab1), end(tab1), begin(tab2)) == Implementation::Optimized);
         REQUIRE(equal(begin(tab1), end(tab1), begin(tab2), end(tab2)));
     }
+
+    SECTION("optimized for contiguous iterators of POD types")
+    {
+        vector<int> vec = {1, 2, 3, 4, 5};
+        array<int, 5> arr{};
+        vector<int> dest(5);
+
+        REQUIRE(mcopy(vec.begin(), vec.end(), arr.begin()) == Implementation::Optimized);
+        REQUIRE(equal(vec.begin(), vec.end(), arr.begin(), arr.end()));
+
+        span<const int> view{arr};
+        REQUIRE(mcopy(view.begin(), view.end(), dest.begin()) == Implementation::Optimized);
+        REQUIRE(dest == vec);
+
+        REQUIRE(mcopy(vec.cbegin(), vec.cbegin(), dest.begin()) == Implementation::Optimized);
+    }
+
+    SECTION("generic for back_inserter")
+    {
+        vector<int> vec = {1, 2, 3};
+        vector<int> dest;
+
+        REQUIRE(mcopy(vec.begin(), vec.end(), back_inserter(dest)) == Implementation::Generic);
+        REQUIRE(dest == vec);
+    }
+}
+
+namespace
+{
+    template <typename TIn, typename TOut>
+    void check_conversion(ConvertKernels::Kernel expected_kernel, TIn first, TIn step)
+    {
+        static_assert(conversion_kernel_v<typename vector<TIn>::iterator, typename vector<TOut>::iterator> != ConvertKernels::Kernel::none);
+        REQUIRE(conversion_kernel_v<typename vector<TIn>::iterator, typename vector<TOut>::iterator> == expected_kernel);
+
+        for (size_t size = 0; size < 40; ++size)
+        {
+            vector<TIn> source(size);
+            for (size_t i = 0; i < size; ++i)
+                source[i] = static_cast<TIn>(first + static_cast<TIn>(i) * step * ((i % 2) ? -1 : 1));
+            vector<TOut> dest(size + 1, TOut{42});
+
+            REQUIRE(mcopy(source.begin(), source.end(), dest.begin()) == Implementation::Converted);
+
+            for (size_t i = 0; i < size; ++i)
+                REQUIRE(dest[i] == static_cast<TOut>(source[i]));
+            REQUIRE(dest[size] == TOut{42});
+        }
+    }
+}
+
+TEST_CASE("mcopy - conversions")
+{
+    using ConvertKernels::Kernel;
+
+    SECTION("widening")
+    {
+        check_conversion<int16_t, int32_t>(Kernel::int16_to_int32, -20'000, 997);
+        check_conversion<int32_t, double>(Kernel::int32_to_double, 100, 50'000'000);
+        check_conversion<float, double>(Kernel::float_to_double, 1.5f, 0.1f);
+        check_conversion<int32_t, long long>(Kernel::int32_to_int64, -2'000'000'000, 123'456'789);
+        check_conversion<int32_t, uint64_t>(Kernel::int32_to_int64, 7, 99'999'999);
+        check_conversion<uint8_t, int32_t>(Kernel::uint8_to_int32, 250, 7);
+        check_conversion<uint8_t, uint32_t>(Kernel::uint8_to_int32, 0, 13);
+        check_conversion<uint16_t, int32_t>(Kernel::uint16_to_int32, 65'000, 4'099);
+    }
+
+    SECTION("narrowing wraps around as static_cast")
+    {
+        check_conversion<int32_t, int16_t>(Kernel::int32_to_int16, 3, 1'999);
+        check_conversion<int64_t, int32_t>(Kernel::int64_to_int32, 5'000'000'000, 3'000'000'007);
+        check_conversion<unsigned long long, int32_t>(Kernel::int64_to_int32, 1ull << 40, 77'777'777'777);
+
+        // the same values through the generic loop
+        const vector<int32_t> source = {40'000, -40'000, 70'000, 32'767, -32'768, 65'535, 1, 2, 100'000};
+        vector<int16_t> converted(source.size());
+        list<int16_t> lst(source.size());
+
+        REQUIRE(mcopy(source.begin(), source.end(), converted.begin()) == Implementation::Converted);
+        REQUIRE(mcopy(source.begin(), source.end(), lst.begin()) == Implementation::Generic);
+        REQUIRE(equal(converted.begin(), converted.end(), lst.begin(), lst.end()));
+        REQUIRE(converted[0] == static_cast<int16_t>(40'000));
+    }
+
+    SECTION("narrowing with saturation is opt-in")
+    {
+        vector<int32_t> source(37);
+        for (size_t i = 0; i < source.size(); ++i)
+            source[i] = static_cast<int32_t>(3 + i * 1'999 * ((i % 2) ? -1 : 1));
+        vector<int16_t> saturated(source.size());
+        list<int16_t> lst(source.size());
+
+        REQUIRE(ConvertKernels::saturated_kernel_v<int32_t, int16_t> == Kernel::int32_to_int16_saturated);
+        REQUIRE(mcopy_saturated(source.begin(), source.end(), saturated.begin()) == Implementation::Converted);
+        REQUIRE(mcopy_saturated(source.begin(), source.end(), lst.begin()) == Implementation::Generic);
+
+        for (size_t i = 0; i < source.size(); ++i)
+            REQUIRE(saturated[i] == std::clamp<int32_t>(source[i], std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max()));
+        REQUIRE(equal(saturated.begin(), saturated.end(), lst.begin(), lst.end()));
+
+        vector<int64_t> big = {std::numeric_limits<int64_t>::min(), -5, std::numeric_limits<int64_t>::max()};
+        vector<uint8_t> bytes(big.size());
+        REQUIRE(mcopy_saturated(big.begin(), big.end(), bytes.begin()) == Implementation::Generic);
+        REQUIRE(bytes == vector<uint8_t>{0, 0, 255});
+    }
+
+    SECTION("between integers and floating point types")
+    {
+        check_conversion<int32_t, float>(Kernel::int32_to_float, 16'777'217, 12'345);
+        check_conversion<float, int32_t>(Kernel::float_to_int32, 0.75f, 1.3f);
+        check_conversion<double, float>(Kernel::double_to_float, 1e-3, 1.0 / 3);
+        check_conversion<double, int32_t>(Kernel::double_to_int32, -0.5, 7.9);
+    }
+
+    SECTION("generic for pairs without kernel or non-contiguous ranges")
+    {
+        // integer pairs of other sizes, e.g. int8_t -> int64_t, have no kernel yet
+        vector<int8_t> source = {1, -2, 3};
+        vector<int64_t> dest(3);
+        list<double> lst(3);
+
+        static_assert(conversion_kernel_v<vector<int8_t>::iterator, vector<int64_t>::iterator> == ConvertKernels::Kernel::none);
+        REQUIRE(mcopy(source.begin(), source.end(), dest.begin()) == Implementation::Generic);
+        REQUIRE(dest == vector<int64_t>{1, -2, 3});
+        REQUIRE(mcopy(source.begin(), source.end(), lst.begin()) == Implementation::Generic);
+        REQUIRE(ConvertKernels::name(conversion_kernel_v<int*, double*>) == std::string{"int32_to_double"});
+    }
+}
+
+TEST_CASE("mmove")
+{
+    SECTION("overlapping ranges of POD types")
+    {
+        vector<int> vec = {1, 2, 3, 4, 5, 6};
+
+        REQUIRE(mmove(vec.begin(), vec.begin() + 4, vec.begin() + 2) == Implementation::Optimized);
+        REQUIRE(vec == vector{1, 2, 1, 2, 3, 4});
+
+        REQUIRE(mmove(vec.begin() + 2, vec.end(), vec.begin()) == Implementation::Optimized);
+        REQUIRE(vec == vector{1, 2, 3, 4, 3, 4});
+    }
+
+    SECTION("overlapping ranges of strings")
+    {
+        vector<string> words = {"1", "2", "3", "4", "5"};
+
+        REQUIRE(mmove(words.begin(), words.begin() + 3, words.begin() + 2) == Implementation::Generic);
+        REQUIRE(vector<string>(words.begin() + 2, words.end()) == vector<string>{"1", "2", "3"});
+
+        REQUIRE(mmove(words.begin() + 2, words.end(), words.begin()) == Implementation::Generic);
+        REQUIRE(vector<string>(words.begin(), words.begin() + 3) == vector<string>{"1", "2", "3"});
+    }
+
+    SECTION("non-contiguous ranges")
+    {
+        list<string> words = {"1", "2", "3"};
+        vector<string> dest(3);
+
+        REQUIRE(mmove(words.begin(), words.end(), dest.begin()) == Implementation::Generic);
+        REQUIRE(dest == vector<string>{"1", "2", "3"});
+    }
+
+    SECTION("contiguous ranges of different types")
+    {
+        vector<int> source = {1, 2, 3};
+        vector<double> dest(3);
+
+        REQUIRE(mmove(source.begin(), source.end(), dest.begin()) == Implementation::Generic);
+        REQUIRE(dest == vector<double>{1.0, 2.0, 3.0});
+    }
+}
+
+namespace
+{
+    // restores the global threshold of large copies also when a test fails
+    class ThresholdGuard
+    {
+        size_t threshold_ = LargeCopy::threshold();
+
+    public:
+        ThresholdGuard() = default;
+        ThresholdGuard(const ThresholdGuard&) = delete;
+        ThresholdGuard& operator=(const ThresholdGuard&) = delete;
+
+        ~ThresholdGuard()
+        {
+            LargeCopy::set_threshold(threshold_);
+        }
+    };
+}
+
+TEST_CASE("mcopy - large copies")
+{
+    ThresholdGuard threshold_guard;
+
+    if (std::getenv("MCOPY_LARGE_THRESHOLD") == nullptr)
+        REQUIRE(LargeCopy::threshold() == std::numeric_limits<size_t>::max()); // opt-in
+    REQUIRE(LargeCopy::suggested_threshold() > 0);
+
+    vector<char> source(3'000'000);
+    for (size_t i = 0; i < source.size(); ++i)
+        source[i] = static_cast<char>(i * 7 + i / 251);
+
+    SECTION("ranges from the threshold are copied by the pool")
+    {
+        LargeCopy::set_threshold(1'000);
+
+        for (size_t offset : {0u, 1u, 13u})
+            for (size_t size : {999u, 1'000u, 4'097u, 2'999'000u})
+            {
+                vector<char> dest(source.size() + 16);
+
+                const auto implementation = mcopy(source.begin() + offset, source.begin() + offset + size, dest.begin() + 3);
+
+                REQUIRE(implementation == (size >= 1'000 ? Implementation::Parallel : Implementation::Optimized));
+                REQUIRE(equal(source.begin() + offset, source.begin() + offset + size, dest.begin() + 3));
+                REQUIRE(dest[2] == 0);
+                REQUIRE(dest[3 + size] == 0);
+            }
+    }
+
+    SECTION("pools with many threads")
+    {
+        LargeCopy::CopyPool pool{4};
+        vector<char> dest(source.size());
+
+        for (int i = 0; i < 10; ++i)
+        {
+            fill(dest.begin(), dest.end(), 0);
+            LargeCopy::parallel_copy(dest.data(), source.data(), source.size(), pool);
+            REQUIRE(dest == source);
+        }
+    }
+}
+
+TEST_CASE("mcopy - vector to vector", "[.benchmark]")
+{
+    for (size_t size : {16u, 1'024u, 65'536u, 1'048'576u})
+    {
+        vector<int> source(size);
+        iota(source.begin(), source.end(), 0);
+        vector<int> dest(size);
+        const auto suffix = " - " + to_string(size) + " ints";
+
+        // vector iterators are not pointers - the generic loop (previous behavior of mcopy)
+        BENCHMARK("SFINAE::mcopy" + suffix)
+        {
+            SFINAE::mcopy(source.begin(), source.end(), dest.begin());
+            return dest.back();
+        };
+
+        BENCHMARK("mcopy" + suffix)
+        {
+            mcopy(source.begin(), source.end(), dest.begin());
+            return dest.back();
+        };
+
+        BENCHMARK("mmove" + suffix)
+        {
+            mmove(source.begin(), source.end(), dest.begin());
+            return dest.back();
+        };
+    }
+}
+
+TEST_CASE("mcopy - GB-scale buffers", "[.benchmark]")
+{
+    ThresholdGuard threshold_guard;
+    vector<char> source(size_t{512} << 20, 'a');
+    vector<char> dest(source.size(), 'b');
+
+    cout << "suggested threshold: " << LargeCopy::suggested_threshold() << " bytes, threads: " << LargeCopy::CopyPool::instance().no_of_threads() << "\n";
+
+    BENCHMARK("memcpy - 512 MB")
+    {
+        memcpy(dest.data(), source.data(), source.size());
+        return dest.back();
+    };
+
+    LargeCopy::set_threshold(source.size());
+    BENCHMARK("mcopy (parallel, streaming stores) - 512 MB")
+    {
+        return mcopy(source.begin(), source.end(), dest.begin());
+    };
 }
 
 template <typename T>
@@ -105,4 +494,69 @@ void push_back(T&& obj)
     // }
 
     T value = std::move_if_noexcept(obj);
-}
\ No newline at end of file
+}
+
+TEST_CASE("mcopy - conversions vs. generic loop", "[.benchmark]")
+{
+    for (size_t size : {16'384u, 1'048'576u})
+    {
+        vector<int> ints(size);
+        iota(ints.begin(), ints.end(), -static_cast<int>(size / 2));
+        vector<float> floats(ints.begin(), ints.end());
+        vector<double> doubles(size);
+        vector<int16_t> shorts(size);
+        vector<int> converted_ints(size);
+        vector<long long> longs(size);
+        const auto suffix = " - " + to_string(size) + " values";
+
+        // vector iterators are not pointers - SFINAE::mcopy always takes the generic loop
+        BENCHMARK("SFINAE::mcopy - int -> double" + suffix)
+        {
+            SFINAE::mcopy(ints.begin(), ints.end(), doubles.begin());
+            return doubles.back();
+        };
+
+        BENCHMARK("mcopy - int -> double" + suffix)
+        {
+            return mcopy(ints.begin(), ints.end(), doubles.begin());
+        };
+
+        BENCHMARK("SFINAE::mcopy - int -> int16_t (wraps)" + suffix)
+        {
+            SFINAE::mcopy(ints.begin(), ints.end(), shorts.begin());
+            return shorts.back();
+        };
+
+        BENCHMARK("mcopy - int -> int16_t (wraps)" + suffix)
+        {
+            return mcopy(ints.begin(), ints.end(), shorts.begin());
+        };
+
+        BENCHMARK("mcopy_saturated - int -> int16_t" + suffix)
+        {
+            return mcopy_saturated(ints.begin(), ints.end(), shorts.begin());
+        };
+
+        BENCHMARK("SFINAE::mcopy - int -> long long" + suffix)
+        {
+            SFINAE::mcopy(ints.begin(), ints.end(), longs.begin());
+            return longs.back();
+        };
+
+        BENCHMARK("mcopy - int -> long long" + suffix)
+        {
+            return mcopy(ints.begin(), ints.end(), longs.begin());
+        };
+
+        BENCHMARK("SFINAE::mcopy - float -> int" + suffix)
+        {
+            SFINAE::mcopy(floats.begin(), floats.end(), converted_ints.begin());
+            return converted_ints.back();
+        };
+
+        BENCHMARK("mcopy - float -> int" + suffix)
+        {
+            return mcopy(floats.begin(), floats.end(), converted_ints.begin());
+        };
+    }
+}
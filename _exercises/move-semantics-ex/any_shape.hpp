@@ -0,0 +1,296 @@
+#ifndef ANY_SHAPE_HPP_
+#define ANY_SHAPE_HPP_
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geometry.hpp"
+#include "render_commands.hpp"
+
+class Shape; // defined in paragraph.hpp
+
+// Value-semantic, type-erased shape
+// - any copyable shape can be stored - small shapes (e.g. Text) are stored inline (no allocation), bigger ones on the heap
+// - a shape owned by unique_ptr stays at its address - it is copied with its virtual clone()
+// - operations are dispatched through a hand-rolled vtable - one static table per stored type
+// - copy makes a deep copy, moved-from any_shape is empty
+class any_shape
+{
+public:
+    static constexpr size_t buffer_size = 80; // sizeof(Text) - checked in paragraph.hpp
+
+private:
+    union Storage
+    {
+        alignas(std::max_align_t) std::byte buffer[buffer_size];
+        void* heap;
+    };
+
+    struct VTable
+    {
+        void (*draw)(const Storage&);
+        void (*record)(const Storage&, RenderCommandBuffer&);
+        Rect (*bounds)(const Storage&);
+        Shape* (*shape)(const Storage&);
+        void (*copy)(const Storage& source, any_shape& target);
+        void (*move)(Storage& source, Storage& target) noexcept; // source is left destroyed
+        void (*destroy)(Storage&) noexcept;
+    };
+
+    template <typename T>
+    static constexpr bool fits_inline = sizeof(T) <= buffer_size
+        && alignof(std::max_align_t) % alignof(T) == 0
+        && std::is_nothrow_move_constructible_v<T>;
+
+    template <typename T>
+    static T& get(Storage& storage)
+    {
+        if constexpr (fits_inline<T>)
+            return *std::launder(reinterpret_cast<T*>(storage.buffer));
+        else
+            return *static_cast<T*>(storage.heap);
+    }
+
+    template <typename T>
+    static const T& get(const Storage& storage)
+    {
+        return get<T>(const_cast<Storage&>(storage));
+    }
+
+    template <typename T, typename... TArgs>
+    static void construct(Storage& storage, TArgs&&... args)
+    {
+        if constexpr (fits_inline<T>)
+            ::new (static_cast<void*>(storage.buffer)) T(std::forward<TArgs>(args)...);
+        else
+            storage.heap = new T(std::forward<TArgs>(args)...);
+    }
+
+    // shapes owned by unique_ptr are called through their virtual functions
+    template <typename T>
+    static constexpr bool is_owned = std::is_same_v<T, std::unique_ptr<Shape>>;
+
+    template <typename T>
+    static Shape* shape_of(const Storage& s)
+    {
+        if constexpr (is_owned<T>)
+            return get<T>(s).get();
+        else
+            return const_cast<T*>(&get<T>(s));
+    }
+
+    template <typename T>
+    static void copy(const Storage& source, any_shape& target)
+    {
+        if constexpr (is_owned<T>)
+            target = get<T>(source)->clone();
+        else
+            target.emplace<T>(get<T>(source));
+    }
+
+    template <typename T>
+    static constexpr VTable vtable_for{
+        [](const Storage& s) {
+            if constexpr (is_owned<T>)
+                get<T>(s)->draw();
+            else
+                get<T>(s).T::draw();
+        },
+        [](const Storage& s, RenderCommandBuffer& buffer) {
+            if constexpr (is_owned<T>)
+                get<T>(s)->record(buffer);
+            else
+                get<T>(s).T::record(buffer);
+        },
+        [](const Storage& s) {
+            if constexpr (is_owned<T>)
+                return get<T>(s)->bounds();
+            else
+                return get<T>(s).T::bounds();
+        },
+        &shape_of<T>,
+        &copy<T>,
+        [](Storage& source, Storage& target) noexcept {
+            if constexpr (fits_inline<T>)
+            {
+                construct<T>(target, std::move(get<T>(source)));
+                get<T>(source).~T();
+            }
+            else
+                target.heap = source.heap;
+        },
+        [](Storage& s) noexcept {
+            if constexpr (fits_inline<T>)
+                get<T>(s).~T();
+            else
+                delete static_cast<T*>(s.heap);
+        }};
+
+    const VTable* vtable_ = nullptr;
+    Storage storage_;
+
+public:
+    template <typename T>
+    static constexpr bool is_stored_inline = fits_inline<T>;
+
+    any_shape() noexcept = default;
+
+    template <typename TShape, typename T = std::decay_t<TShape>>
+        requires std::derived_from<T, Shape> && std::is_copy_constructible_v<T>
+    any_shape(TShape&& shape)
+        : vtable_{&vtable_for<T>}
+    {
+        construct<T>(storage_, std::forward<TShape>(shape));
+    }
+
+    template <typename T, typename... TArgs>
+    explicit any_shape(std::in_place_type_t<T>, TArgs&&... args)
+        : vtable_{&vtable_for<T>}
+    {
+        construct<T>(storage_, std::forward<TArgs>(args)...);
+    }
+
+    // null shape gives empty any_shape
+    template <typename TShape>
+        requires std::derived_from<TShape, Shape>
+    any_shape(std::unique_ptr<TShape> shape) noexcept
+    {
+        if (shape)
+        {
+            construct<std::unique_ptr<Shape>>(storage_, std::move(shape));
+            vtable_ = &vtable_for<std::unique_ptr<Shape>>;
+        }
+    }
+
+    any_shape(const any_shape& source)
+    {
+        if (source.vtable_)
+            source.vtable_->copy(source.storage_, *this);
+    }
+
+    any_shape(any_shape&& source) noexcept
+        : vtable_{std::exchange(source.vtable_, nullptr)}
+    {
+        if (vtable_)
+            vtable_->move(source.storage_, storage_);
+    }
+
+    any_shape& operator=(const any_shape& source)
+    {
+        if (this != &source)
+        {
+            any_shape temp{source};
+            *this = std::move(temp);
+        }
+        return *this;
+    }
+
+    any_shape& operator=(any_shape&& source) noexcept
+    {
+        if (this != &source)
+        {
+            reset();
+            vtable_ = std::exchange(source.vtable_, nullptr);
+            if (vtable_)
+                vtable_->move(source.storage_, storage_);
+        }
+        return *this;
+    }
+
+    ~any_shape()
+    {
+        reset();
+    }
+
+    template <typename T, typename... TArgs>
+    T& emplace(TArgs&&... args)
+    {
+        reset();
+        construct<T>(storage_, std::forward<TArgs>(args)...);
+        vtable_ = &vtable_for<T>;
+        return get<T>(storage_);
+    }
+
+    void reset() noexcept
+    {
+        if (vtable_)
+            std::exchange(vtable_, nullptr)->destroy(storage_);
+    }
+
+    bool has_value() const noexcept
+    {
+        return vtable_ != nullptr;
+    }
+
+    // stored shape - nullptr when empty
+    Shape* get() noexcept
+    {
+        return vtable_ ? vtable_->shape(storage_) : nullptr;
+    }
+
+    const Shape* get() const noexcept
+    {
+        return vtable_ ? vtable_->shape(storage_) : nullptr;
+    }
+
+    Shape& operator*() noexcept
+    {
+        assert(vtable_);
+        return *get();
+    }
+
+    const Shape& operator*() const noexcept
+    {
+        assert(vtable_);
+        return *get();
+    }
+
+    Shape* operator->() noexcept
+    {
+        return get();
+    }
+
+    const Shape* operator->() const noexcept
+    {
+        return get();
+    }
+
+    // shape stored by value as T - shapes owned by unique_ptr are not targets
+    template <typename T>
+    T* target() noexcept
+    {
+        return vtable_ == &vtable_for<T> ? &get<T>(storage_) : nullptr;
+    }
+
+    template <typename T>
+    const T* target() const noexcept
+    {
+        return vtable_ == &vtable_for<T> ? &get<T>(storage_) : nullptr;
+    }
+
+    void draw() const
+    {
+        assert(vtable_);
+        vtable_->draw(storage_);
+    }
+
+    void record(RenderCommandBuffer& buffer) const
+    {
+        assert(vtable_);
+        vtable_->record(storage_, buffer);
+    }
+
+    Rect bounds() const
+    {
+        assert(vtable_);
+        return vtable_->bounds(storage_);
+    }
+};
+
+#endif /*ANY_SHAPE_HPP_*/
@@ -0,0 +1,59 @@
+#ifndef GEOMETRY_HPP_
+#define GEOMETRY_HPP_
+
+#include <algorithm>
+#include <limits>
+
+// axis aligned rectangle [left, right) x [top, bottom)
+struct Rect
+{
+    int left = 0, top = 0, right = 0, bottom = 0;
+
+    // point at INT_MAX can not be represented - its bounds are empty
+    static Rect point(int x, int y)
+    {
+        return Rect{x, y, saturated_next(x), saturated_next(y)};
+    }
+
+    // bounds of shapes that do not know their extent - intersect every non-empty area
+    static Rect unbounded()
+    {
+        return Rect{std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+    }
+
+    bool is_unbounded() const
+    {
+        return *this == unbounded();
+    }
+
+    bool empty() const
+    {
+        return left >= right || top >= bottom;
+    }
+
+    bool intersects(const Rect& other) const
+    {
+        return !empty() && !other.empty()
+            && left < other.right && other.left < right
+            && top < other.bottom && other.top < bottom;
+    }
+
+    Rect united(const Rect& other) const
+    {
+        if (empty())
+            return other;
+        if (other.empty())
+            return *this;
+        return Rect{std::min(left, other.left), std::min(top, other.top), std::max(right, other.right), std::max(bottom, other.bottom)};
+    }
+
+    bool operator==(const Rect&) const = default;
+
+private:
+    static int saturated_next(int value)
+    {
+        return (value < std::numeric_limits<int>::max()) ? value + 1 : value;
+    }
+};
+
+#endif /*GEOMETRY_HPP_*/
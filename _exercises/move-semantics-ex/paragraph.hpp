@@ -1,103 +1,582 @@
 #ifndef PARAGRAPH_HPP_
 #define PARAGRAPH_HPP_
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "any_shape.hpp"
+#include "geometry.hpp"
+#include "position_table.hpp"
+#include "render_commands.hpp"
+#include "rope.hpp"
+#include "spatial_index.hpp"
+#include "text_index.hpp"
+#include "text_kernels.hpp"
+#include "text_pool.hpp"
+#include "thread_budget.hpp"
 
 namespace LegacyCode
 {
-    // TODO - implement move semantics for Paragraph
+    // Paragraph stores its length; short text (up to sso_capacity chars) is kept inline,
+    // longer text is allocated on the heap with exactly the needed size
+    // - paragraph may also refer to an immutable SharedText (flyweight) - copies of it share the text
+    // - long, frequently edited text may be stored in a Rope (use_rope()) - insert()/erase() cost O(log n)
+    // - moved-from paragraph has no text (get_paragraph() returns nullptr)
     class Paragraph
     {
-        char* buffer_;
+    public:
+        static constexpr size_t sso_capacity = 15;
+
+    private:
+        char* buffer_; // points to sso_buffer_, heap, shared text (read-only) or nullptr (moved-from, rope)
+        size_t size_ : 62;
+        size_t is_shared_ : 1 = false; // flags share the word of size_ - Paragraph stays 40 bytes
+        size_t is_rope_ : 1 = false;
+
+        union
+        {
+            size_t capacity_; // when allocated on the heap
+            char sso_buffer_[sso_capacity + 1];
+            std::shared_ptr<const char> shared_; // when is_shared_
+            Rope* rope_; // when is_rope_
+        };
+
+        struct Empty
+        { };
+
+        Paragraph(Empty)
+            : buffer_{nullptr}
+            , size_{0}
+            , capacity_{0}
+        {
+        }
+
+        bool is_inline() const
+        {
+            return buffer_ == sso_buffer_;
+        }
+
+        void assign(const char* txt, size_t size)
+        {
+            if (is_rope_)
+            {
+                rope_->assign(std::string_view{txt, size});
+                size_ = size;
+                return;
+            }
+
+            // txt may point into shared text released below
+            const std::shared_ptr<const char> keep_alive = is_shared_ ? shared_ : nullptr;
+
+            // shared text is immutable - it is never overwritten in place
+            if (!is_shared_ && buffer_ != nullptr && size <= capacity())
+            {
+                std::memmove(buffer_, txt, size);
+            }
+            else if (size <= sso_capacity)
+            {
+                release();
+                buffer_ = sso_buffer_;
+                std::memcpy(buffer_, txt, size);
+            }
+            else
+            {
+                char* new_buffer = new char[size + 1];
+                std::memcpy(new_buffer, txt, size);
+                release();
+                buffer_ = new_buffer;
+                capacity_ = size;
+            }
+
+            buffer_[size] = '\0';
+            size_ = size;
+        }
+
+        void release() noexcept
+        {
+            if (is_shared_)
+            {
+                shared_.~shared_ptr();
+                is_shared_ = false;
+            }
+            else if (is_rope_)
+            {
+                delete rope_;
+                is_rope_ = false;
+            }
+            else if (buffer_ != nullptr && !is_inline())
+                delete[] buffer_;
+            buffer_ = nullptr;
+            size_ = 0;
+        }
+
+        // takes the text of p - *this must not own any buffer
+        void steal(Paragraph& p) noexcept
+        {
+            if (p.is_shared_)
+            {
+                ::new (&shared_) std::shared_ptr<const char>{std::move(p.shared_)};
+                p.shared_.~shared_ptr();
+                p.is_shared_ = false;
+                is_shared_ = true;
+                buffer_ = p.buffer_;
+            }
+            else if (p.is_rope_)
+            {
+                rope_ = p.rope_;
+                p.is_rope_ = false;
+                is_rope_ = true;
+                buffer_ = nullptr;
+            }
+            else if (p.is_inline())
+            {
+                std::memcpy(sso_buffer_, p.sso_buffer_, p.size_ + 1);
+                buffer_ = sso_buffer_;
+            }
+            else
+            {
+                buffer_ = p.buffer_;
+                capacity_ = p.capacity_;
+            }
+            size_ = p.size_;
+
+            p.buffer_ = nullptr;
+            p.size_ = 0;
+        }
+
+        void copy_rope(const Paragraph& p)
+        {
+            auto rope = std::make_unique<Rope>(*p.rope_);
+            release();
+            rope_ = rope.release();
+            is_rope_ = true;
+            size_ = p.size_;
+        }
+
+        // text of a paragraph that is not a rope
+        std::string_view view() const
+        {
+            assert(!is_rope_);
+            return (buffer_ == nullptr) ? std::string_view{} : std::string_view{buffer_, size_};
+        }
+
+        // start of a multi-byte UTF-8 sequence at the end of text that is not complete (text.size() if there is none)
+        static size_t incomplete_utf8_tail(std::string_view text)
+        {
+            for (size_t back = 1; back <= std::min<size_t>(3, text.size()); ++back)
+            {
+                const auto byte = static_cast<unsigned char>(text[text.size() - back]);
+                if ((byte & 0xC0) != 0x80) // first byte of a sequence
+                {
+                    const size_t length = (byte >= 0xF0) ? 4 : (byte >= 0xE0) ? 3 : (byte >= 0xC0) ? 2 : 1;
+                    return (length > back) ? text.size() - back : text.size();
+                }
+            }
+            return text.size();
+        }
 
     protected:
-        void swap(Paragraph& p)
+        void swap(Paragraph& p) noexcept
         {
-            std::swap(buffer_, p.buffer_);
+            Paragraph temp{Empty{}};
+            temp.steal(p);
+            p.steal(*this);
+            steal(temp);
         }
 
     public:
         Paragraph()
-            : buffer_(new char[1024])
+            : Paragraph{"Default text!"}
         {
-            std::strcpy(buffer_, "Default text!");
         }
 
         Paragraph(const Paragraph& p)
-            : buffer_(new char[1024])
+            : Paragraph{Empty{}}
+        {
+            if (p.is_shared_)
+                share(p.shared());
+            else if (p.is_rope_)
+                copy_rope(p);
+            else if (p.buffer_ != nullptr)
+                assign(p.buffer_, p.size_);
+        }
+
+        explicit Paragraph(SharedText txt)
+            : Paragraph{Empty{}}
         {
-            std::strcpy(buffer_, p.buffer_);
+            share(std::move(txt));
         }
 
         Paragraph(const char* txt)
-            : buffer_(new char[1024])
+            : Paragraph{Empty{}}
         {
-            std::strcpy(buffer_, txt);
+            assign(txt, std::strlen(txt));
         }
 
         Paragraph& operator=(const Paragraph& p)
         {
-            Paragraph temp(p);
-            swap(temp);
+            if (this != &p)
+            {
+                if (p.is_shared_)
+                    share(p.shared());
+                else if (p.is_rope_)
+                    copy_rope(p);
+                else if (p.buffer_ == nullptr)
+                    release();
+                else
+                    assign(p.buffer_, p.size_);
+            }
 
             return *this;
         }
 
-        Paragraph(Paragraph&& p)
-            : buffer_(p.buffer_)
+        Paragraph(Paragraph&& p) noexcept
+            : Paragraph{Empty{}}
         {
-            p.buffer_ = nullptr;
+            steal(p);
         }
 
-        Paragraph& operator=(Paragraph&& p)
+        Paragraph& operator=(Paragraph&& p) noexcept
         {
-            if(this != &p)
+            if (this != &p)
             {
-                Paragraph temp = std::move(p);
-                swap(temp);
+                release();
+                steal(p);
             }
             return *this;
         }
 
         void set_paragraph(const char* txt)
         {
-            std::strcpy(buffer_, txt);
+            assign(txt, std::strlen(txt));
+        }
+
+        // refers to shared text instead of owning a copy
+        void share(SharedText txt)
+        {
+            if (!txt)
+            {
+                release();
+                return;
+            }
+
+            std::shared_ptr<const char> data = txt.data();
+            release();
+            ::new (&shared_) std::shared_ptr<const char>{std::move(data)};
+            is_shared_ = true;
+            buffer_ = const_cast<char*>(shared_.get()); // never written while shared
+            size_ = txt.size();
+        }
+
+        bool is_shared() const
+        {
+            return is_shared_;
+        }
+
+        SharedText shared() const
+        {
+            return is_shared_ ? SharedText{shared_, size_} : SharedText{};
+        }
+
+        // stores text in a Rope - converted text is kept
+        void use_rope()
+        {
+            if (is_rope_ || get_paragraph() == nullptr)
+                return;
+
+            auto rope = std::make_unique<Rope>(view());
+            const size_t size = size_;
+            release();
+            rope_ = rope.release();
+            is_rope_ = true;
+            size_ = size;
+        }
+
+        bool is_rope() const
+        {
+            return is_rope_;
+        }
+
+        // pos <= size(); O(log n) for rope, O(n) otherwise
+        void insert(size_t pos, std::string_view txt)
+        {
+            if (is_rope_)
+            {
+                rope_->insert(pos, txt);
+                size_ = rope_->size();
+                return;
+            }
+
+            std::string text{view()};
+            text.insert(pos, txt);
+            assign(text.data(), text.size());
+        }
+
+        // erases at most count chars starting at pos <= size(); O(log n) for rope, O(n) otherwise
+        void erase(size_t pos, size_t count)
+        {
+            if (is_rope_)
+            {
+                rope_->erase(pos, count);
+                size_ = rope_->size();
+                return;
+            }
+
+            std::string text{view()};
+            text.erase(pos, count);
+            assign(text.data(), text.size());
+        }
+
+        std::string substr(size_t pos, size_t count) const
+        {
+            if (is_rope_)
+                return rope_->substr(pos, count);
+            return std::string{view().substr(pos, count)};
+        }
+
+        static constexpr size_t npos = std::string_view::npos;
+
+        // position of the first c at or after pos or npos
+        size_t find(char c, size_t pos = 0) const
+        {
+            return is_rope_ ? rope_->find(c, pos) : view().find(c, pos);
+        }
+
+        // position of the first occurrence of txt at or after pos or npos
+        size_t find(std::string_view txt, size_t pos = 0) const
+        {
+            return is_rope_ ? rope_->find(txt, pos) : view().find(txt, pos);
+        }
+
+        // rope is validated chunk by chunk - a sequence split between chunks is carried to the next chunk
+        bool is_valid_utf8() const
+        {
+            if (!is_rope_)
+                return TextKernels::is_valid_utf8(view());
+
+            bool is_valid = true;
+            std::string carry;
+            rope_->for_each_chunk([&](std::string_view chunk) {
+                if (!is_valid)
+                    return;
+
+                std::string joined;
+                if (!carry.empty())
+                {
+                    carry.append(chunk);
+                    joined = std::move(carry);
+                    chunk = joined;
+                }
+
+                const size_t tail = incomplete_utf8_tail(chunk);
+                is_valid = TextKernels::is_valid_utf8(chunk.substr(0, tail));
+                carry = chunk.substr(tail);
+            });
+
+            return is_valid && carry.empty();
+        }
+
+        // calls f(std::string_view) for chunks of the text in order - text that is not a rope is one chunk
+        template <typename F>
+        void for_each_chunk(F&& f) const
+        {
+            if (is_rope_)
+                rope_->for_each_chunk(f);
+            else if (buffer_ != nullptr)
+                f(std::string_view{buffer_, size_});
+        }
+
+        std::string str() const
+        {
+            return is_rope_ ? rope_->str() : std::string{view()};
+        }
+
+        // rope is flattened on the first call after an edit
+        const char* get_paragraph()
+        {
+            return is_rope_ ? rope_->c_str() : buffer_;
         }
 
+        // rope is not flattened - it returns text flattened by the last non-const get_paragraph(),
+        // nullptr when the rope was edited since (for_each_chunk() and str() give the current text)
         const char* get_paragraph() const
         {
-            return buffer_;
+            return is_rope_ ? rope_->flattened() : buffer_;
         }
 
+        size_t size() const
+        {
+            return size_;
+        }
+
+        size_t capacity() const
+        {
+            if (buffer_ == nullptr || is_shared_ || is_rope_)
+                return 0;
+            return is_inline() ? sso_capacity : capacity_;
+        }
+
+        // rope is written chunk by chunk - without flattening
         void render_at(int posx, int posy) const
         {
+            if (is_rope_)
+            {
+                std::cout << "Rendering text '";
+                rope_->for_each_chunk([](std::string_view chunk) { std::cout.write(chunk.data(), static_cast<std::streamsize>(chunk.size())); });
+                std::cout << "' at: [" << posx << ", " << posy << "]" << std::endl;
+                return;
+            }
+
             std::cout << "Rendering text '" << buffer_ << "' at: [" << posx << ", " << posy << "]" << std::endl;
         }
 
         virtual ~Paragraph()
         {
-            delete[] buffer_;
+            release();
         }
     };
 }
 
+struct ShapeGroup;
+
 class Shape
 {
+    ShapeGroup* parent_ = nullptr;
+    uint32_t index_in_parent_ = 0;
+
+    friend struct ShapeGroup;
+
+    // called when the shape is added to a group - shape may keep its position in the group's table
+    virtual void bind_position(PositionTable& table)
+    {
+        (void)table;
+    }
+
+    // called when the shape is removed from its group - shape must release its slot in the table
+    virtual void unbind_position(PositionTable& table)
+    {
+        (void)table;
+    }
+
+protected:
+    // notifies parent group that rendering of the shape changed
+    void mark_dirty();
+
+    // table of the parent group - nullptr when the shape is not a member of any group
+    PositionTable* position_table() const;
+
 public:
+    Shape() = default;
+
+    // copy is not a member of any group
+    Shape(const Shape&) noexcept
+    {
+    }
+
+    Shape& operator=(const Shape&) noexcept
+    {
+        return *this;
+    }
+
     virtual ~Shape() = default;
     virtual void draw() const = 0;
+
+    // shapes that do not record their own commands are drawn with draw_to() when the buffer is executed
+    virtual void record(RenderCommandBuffer& buffer) const
+    {
+        buffer.record_draw(*this);
+    }
+
+    // writes output of draw() to out - shapes recorded as Draw commands override it to be rendered
+    // into strings (ShapeGroup::rendered(), redraw(), draw_parallel())
+    // - shapes that implement only draw() can be drawn only to std::cout
+    virtual void draw_to(std::ostream& out) const
+    {
+        if (&out != &std::cout)
+            throw std::runtime_error("Shape can be drawn only to std::cout - draw_to() is not overridden");
+        draw();
+    }
+
+
+    // shapes that do not know their extent are unbounded - they are candidates of every area query
+    virtual Rect bounds() const
+    {
+        return Rect::unbounded();
+    }
+
+    // composite shapes may split recording between threads taken from budget
+    virtual void record_parallel(RenderCommandBuffer& buffer, ThreadBudget& budget) const
+    {
+        (void)budget;
+        record(buffer);
+    }
+
+    // text indexed by ShapeGroup::enable_text_index() - empty for shapes without text
+    virtual std::string_view searchable_text() const
+    {
+        return {};
+    }
+
+    // appends rendered output of the shape
+    virtual void render(std::string& output) const
+    {
+        RenderCommandBuffer buffer;
+        record(buffer);
+        buffer.render(output);
+    }
+
+    // copy of the shape for a copy of a ShapeGroup, where it was added as unique_ptr
+    // - shapes that do not override it can not be copied
+    virtual any_shape clone() const
+    {
+        throw std::runtime_error("Shape can not be copied - clone() is not overridden");
+    }
 };
 
-// TODO - ensure that Text is copyable & moveable type
+// Text added to ShapeGroup keeps its position in slot_ of the group's PositionTable
+// - the table is found through the parent group, so the binding follows membership in a group
+// - copies and moved-to objects are not bound to any table
 class Text : public Shape
 {
-    int x_, y_;
+    int x_, y_; // position while the text is not a member of any group
+    uint32_t slot_ = 0;
+    TextPool* pool_ = nullptr; // pool of flyweight text - global pool when nullptr
     LegacyCode::Paragraph p_;
 
+    void bind_position(PositionTable& table) override
+    {
+        slot_ = table.insert(x_, y_);
+    }
+
+    void unbind_position(PositionTable& table) override
+    {
+        x_ = table.x(slot_);
+        y_ = table.y(slot_);
+        table.erase(slot_);
+    }
+
+    void set_position(int x, int y)
+    {
+        if (PositionTable* table = position_table())
+            table->set(slot_, x, y);
+        else
+        {
+            x_ = x;
+            y_ = y;
+        }
+    }
+
 public:
     Text(int x, int y, const std::string& text)
         : x_{x}
@@ -106,39 +585,881 @@ public:
     {
     }
 
+    // flyweight mode - text refers to shared immutable block
+    Text(int x, int y, SharedText text)
+        : x_{x}
+        , y_{y}
+        , p_{std::move(text)}
+    {
+    }
+
+    Text(const Text& source)
+        : Shape{source}
+        , x_{source.x()}
+        , y_{source.y()}
+        , pool_{source.pool_}
+        , p_{source.p_}
+    {
+    }
+
+    Text(Text&& source) noexcept
+        : Shape{source}
+        , x_{source.x()}
+        , y_{source.y()}
+        , pool_{source.pool_}
+        , p_{std::move(source.p_)}
+    {
+    }
+
+    Text& operator=(const Text& source)
+    {
+        if (this != &source)
+        {
+            set_position(source.x(), source.y());
+            pool_ = source.pool_;
+            p_ = source.p_;
+            mark_dirty();
+        }
+        return *this;
+    }
+
+    // not noexcept - the change is reported to the parent group, which may allocate
+    Text& operator=(Text&& source)
+    {
+        if (this != &source)
+        {
+            set_position(source.x(), source.y());
+            pool_ = source.pool_;
+            p_ = std::move(source.p_);
+            mark_dirty();
+        }
+        return *this;
+    }
+
+    ~Text() override
+    {
+        if (PositionTable* table = position_table())
+            table->erase(slot_);
+    }
+
+    // pool must outlive the text - set_text() interns new text in the same pool
+    static Text flyweight(int x, int y, std::string_view text, TextPool& pool = TextPool::global())
+    {
+        Text result{x, y, pool.intern(text)};
+        result.pool_ = &pool;
+        return result;
+    }
+
     void draw() const override
     {
-        p_.render_at(x_, y_);
+        p_.render_at(x(), y());
+    }
+
+    // text is recorded chunk by chunk - text stored in a rope is not flattened
+    void record(RenderCommandBuffer& buffer) const override
+    {
+        buffer.record_text(x(), y(), {});
+        p_.for_each_chunk([&buffer](std::string_view chunk) { buffer.append_text(chunk); });
+    }
+
+    // text is one line of cells, one cell per char starting at the anchor (at least one cell for empty text)
+    Rect bounds() const override
+    {
+        const int64_t width = std::max<int64_t>(static_cast<int64_t>(p_.size()), 1);
+        return Rect{x(), y(), static_cast<int>(std::min<int64_t>(x() + width, std::numeric_limits<int>::max())),
+            static_cast<int>(std::min<int64_t>(int64_t{y()} + 1, std::numeric_limits<int>::max()))};
+    }
+
+    int x() const
+    {
+        const PositionTable* table = position_table();
+        return table ? table->x(slot_) : x_;
+    }
+
+    int y() const
+    {
+        const PositionTable* table = position_table();
+        return table ? table->y(slot_) : y_;
+    }
+
+    void move_to(int x, int y)
+    {
+        set_position(x, y);
+        mark_dirty();
     }
 
     std::string text() const
+    {
+        return p_.str();
+    }
+
+    std::string_view searchable_text() const override
     {
         const char* txt = p_.get_paragraph();
-        return (txt == nullptr) ? "" : txt;
+        return (txt == nullptr) ? std::string_view{} : std::string_view{txt, p_.size()};
+    }
+
+    size_t find(char c, size_t pos = 0) const
+    {
+        return p_.find(c, pos);
+    }
+
+    size_t find(std::string_view txt, size_t pos = 0) const
+    {
+        return p_.find(txt, pos);
+    }
+
+    // labels from untrusted sources should be validated before rendering
+    bool is_valid_utf8() const
+    {
+        return p_.is_valid_utf8();
     }
 
+    // in flyweight mode text is interned in the pool of the text - only the reference is changed
     void set_text(const std::string& text)
     {
-        p_.set_paragraph(text.c_str());
+        if (p_.is_shared())
+            p_.share((pool_ ? *pool_ : TextPool::global()).intern(text));
+        else
+            p_.set_paragraph(text.c_str());
+        mark_dirty();
     }
-};
 
-struct ShapeGroup : public Shape
-{
-    std::vector<std::unique_ptr<Shape>> shapes;
+    void set_text(SharedText text)
+    {
+        p_.share(std::move(text));
+        mark_dirty();
+    }
 
-    ShapeGroup() = default;
+    bool is_flyweight() const
+    {
+        return p_.is_shared();
+    }
 
-    void draw() const override
+    const LegacyCode::Paragraph& paragraph() const
     {
-        for (const auto& s : shapes)
-            s->draw();
+        return p_;
     }
 
-    void add(std::unique_ptr<Shape> ptr)
+    any_shape clone() const override
     {
-        shapes.push_back(std::move(ptr));
+        return *this;
     }
 };
 
+static_assert(any_shape::is_stored_inline<Text>, "any_shape::buffer_size is too small for Text");
+
+// shapes of the group are any_shape values in the public list shapes
+// - shapes added by value (e.g. add(Text{...}), emplace<Text>()) are stored inline in the list - no allocation per shape;
+//   like elements of a vector they move when the list grows or a shape is removed
+// - shapes added as unique_ptr stay at their address
+// - the list is modified only through the group (add(), remove(), shapes.push_back(), shapes.pop_back(), ...),
+//   which keeps the optional indexes and the rendering cache in sync with indexes of shapes
+// - changes of shapes (Text::set_text(), Text::move_to()) are propagated up through nested groups
+// - redraw() re-renders only changed shapes and reuses cached output of others
+// - copy of a group is deep - inline shapes are copied in place, others with clone()
+// - change tracking is not thread safe - shapes of a group must not be modified concurrently
+struct ShapeGroup : public Shape
+{
+    // vector-like view of shapes - elements are pointers to shapes, modifications go through the group
+    class ShapeList
+    {
+        ShapeGroup* group_;
+        std::vector<any_shape> items_;
+
+        friend struct ShapeGroup;
+
+        explicit ShapeList(ShapeGroup& group)
+            : group_{&group}
+        {
+        }
+
+        ShapeList(ShapeGroup& group, std::vector<any_shape> items)
+            : group_{&group}
+            , items_{std::move(items)}
+        {
+        }
+
+        template <typename TShape, typename TItem>
+        class Iterator
+        {
+            TItem* item_ = nullptr;
+
+        public:
+            using value_type = TShape*;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+
+            explicit Iterator(TItem* item)
+                : item_{item}
+            {
+            }
+
+            TShape* operator*() const
+            {
+                return item_->get();
+            }
+
+            Iterator& operator++()
+            {
+                ++item_;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                return Iterator{item_++};
+            }
+
+            bool operator==(const Iterator&) const = default;
+        };
+
+    public:
+        using iterator = Iterator<Shape, any_shape>;
+        using const_iterator = Iterator<const Shape, const any_shape>;
+
+        ShapeList(const ShapeList&) = delete;
+        ShapeList& operator=(const ShapeList&) = delete;
+
+        size_t size() const
+        {
+            return items_.size();
+        }
+
+        bool empty() const
+        {
+            return items_.empty();
+        }
+
+        Shape* operator[](size_t index)
+        {
+            return items_[index].get();
+        }
+
+        const Shape* operator[](size_t index) const
+        {
+            return items_[index].get();
+        }
+
+        Shape* front()
+        {
+            return items_.front().get();
+        }
+
+        const Shape* front() const
+        {
+            return items_.front().get();
+        }
+
+        Shape* back()
+        {
+            return items_.back().get();
+        }
+
+        const Shape* back() const
+        {
+            return items_.back().get();
+        }
+
+        iterator begin()
+        {
+            return iterator{items_.data()};
+        }
+
+        iterator end()
+        {
+            return iterator{items_.data() + items_.size()};
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator{items_.data()};
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator{items_.data() + items_.size()};
+        }
+
+        void push_back(any_shape shape)
+        {
+            group_->add(std::move(shape));
+        }
+
+        void pop_back()
+        {
+            group_->remove(items_.size() - 1);
+        }
+
+        void clear()
+        {
+            while (!items_.empty())
+                pop_back();
+        }
+
+        void reserve(size_t capacity)
+        {
+            group_->reserve(capacity);
+        }
+    };
+
+    ShapeList shapes{*this};
+
+    ShapeGroup() = default;
+
+    ShapeGroup(const ShapeGroup& source)
+        : Shape{source}
+        , shapes{*this, source.shapes.items_}
+        , subgroups_{source.subgroups_}
+        , cache_{source.cache_}
+    {
+        bind_from(0);
+        if (source.index_)
+            enable_spatial_index(source.index_->cell_size());
+        if (source.text_index_)
+            enable_text_index();
+    }
+
+    ShapeGroup(ShapeGroup&& source) noexcept
+        : Shape{source}
+        , shapes{*this, std::move(source.shapes.items_)}
+        , positions_{std::move(source.positions_)}
+        , index_{std::move(source.index_)}
+        , text_index_{std::move(source.text_index_)}
+        , subgroups_{std::move(source.subgroups_)}
+        , cache_{std::exchange(source.cache_, {})}
+    {
+        adopt_children();
+    }
+
+    ShapeGroup& operator=(const ShapeGroup& source)
+    {
+        if (this != &source)
+            *this = ShapeGroup{source};
+        return *this;
+    }
+
+    ShapeGroup& operator=(ShapeGroup&& source) noexcept
+    {
+        if (this != &source)
+        {
+            shapes.items_ = std::move(source.shapes.items_);
+            index_ = std::move(source.index_);
+            text_index_ = std::move(source.text_index_);
+            positions_ = std::move(source.positions_);
+            subgroups_ = std::move(source.subgroups_);
+            cache_ = std::exchange(source.cache_, {});
+            adopt_children();
+            mark_dirty();
+        }
+        return *this;
+    }
+
+    ~ShapeGroup() override
+    {
+        positions_.reset(); // destroyed Text shapes do not release their slots one by one
+    }
+
+    any_shape clone() const override
+    {
+        return *this;
+    }
+
+    // records the whole group and renders it with a single write
+    void draw() const override
+    {
+        RenderCommandBuffer buffer;
+        record(buffer);
+        buffer.execute(std::cout);
+    }
+
+    void record(RenderCommandBuffer& buffer) const override
+    {
+        for (const auto& s : shapes.items_)
+            s.record(buffer);
+    }
+
+    Rect bounds() const override
+    {
+        Rect result;
+        for (const auto& s : shapes.items_)
+            result = result.united(s.bounds());
+        return result;
+    }
+
+    static constexpr size_t min_shapes_per_thread = 4096;
+
+    void record_parallel(RenderCommandBuffer& buffer, ThreadBudget& budget) const override
+    {
+        const auto& items = shapes.items_;
+
+        if (items.size() < 2 * min_shapes_per_thread || budget.available() == 0)
+        {
+            for (const auto& s : items)
+                s->record_parallel(buffer, budget);
+            return;
+        }
+
+        auto chunks = parallel_chunks<RenderCommandBuffer>(budget, items.size(), min_shapes_per_thread,
+            [&](size_t first, size_t last, RenderCommandBuffer& chunk_buffer) {
+                for (size_t i = first; i < last; ++i)
+                    items[i]->record_parallel(chunk_buffer, budget);
+            });
+
+        for (const auto& chunk_buffer : chunks)
+            buffer.append(chunk_buffer);
+    }
+
+    // every thread records & renders its chunk of shapes; output is the same as output of draw()
+    void draw_parallel(unsigned no_of_threads = std::thread::hardware_concurrency()) const
+    {
+        const auto& items = shapes.items_;
+        ThreadBudget budget{no_of_threads};
+
+        auto chunks = parallel_chunks<std::string>(budget, items.size(), min_shapes_per_thread,
+            [&](size_t first, size_t last, std::string& output) {
+                RenderCommandBuffer chunk_buffer;
+                for (size_t i = first; i < last; ++i)
+                    items[i]->record_parallel(chunk_buffer, budget);
+                chunk_buffer.render(output);
+            });
+
+        std::string frame;
+        size_t frame_size = 0;
+        for (const auto& output : chunks)
+            frame_size += output.size();
+        frame.reserve(frame_size);
+        for (const auto& output : chunks)
+            frame += output;
+
+        std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        std::cout.flush();
+    }
+
+    // shape must not be a member of another group
+    void add(any_shape shape)
+    {
+        const bool is_group = dynamic_cast<const ShapeGroup*>(shape.get()) != nullptr;
+        add(std::move(shape), is_group);
+    }
+
+    // shape is constructed in place - the reference is valid until the group is modified
+    template <typename TShape, typename... TArgs>
+    TShape& emplace(TArgs&&... args)
+    {
+        add(any_shape{std::in_place_type<TShape>, std::forward<TArgs>(args)...}, std::derived_from<TShape, ShapeGroup>);
+        return static_cast<TShape&>(*shapes.items_.back());
+    }
+
+    // removes the shape at index - following shapes move one index down
+    // - O(n) - indexes are rebuilt unless the last shape is removed
+    any_shape remove(size_t index)
+    {
+        auto& items = shapes.items_;
+
+        Shape& shape = *items[index];
+        shape.unbind_position(*positions_);
+        shape.parent_ = nullptr;
+        shape.index_in_parent_ = 0;
+        any_shape removed = std::move(items[index]);
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(index));
+        bind_from(index);
+
+        std::erase(subgroups_, static_cast<uint32_t>(index));
+        for (uint32_t& group_index : subgroups_)
+            group_index -= (group_index > index) ? 1 : 0;
+
+        const bool is_last = index == items.size();
+        if (index_)
+        {
+            if (is_last)
+                index_->erase(static_cast<uint32_t>(index));
+            else
+                enable_spatial_index(index_->cell_size());
+        }
+        if (text_index_)
+        {
+            if (is_last)
+                text_index_->update(static_cast<uint32_t>(index), {});
+            else
+                enable_text_index();
+        }
+
+        // output of the removed shape is cut out of the cached frame
+        const size_t output_begin = cache_.offsets[index];
+        const size_t output_size = cache_.output_size(index);
+        cache_.frame.erase(output_begin, output_size);
+        cache_.offsets.erase(cache_.offsets.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+        for (size_t i = index + 1; i < cache_.offsets.size(); ++i)
+            cache_.offsets[i] -= output_size;
+        cache_.is_dirty.erase(cache_.is_dirty.begin() + static_cast<std::ptrdiff_t>(index));
+        std::erase(cache_.dirty_children, static_cast<uint32_t>(index));
+        for (uint32_t& dirty_index : cache_.dirty_children)
+            dirty_index -= (dirty_index > index) ? 1 : 0;
+        if (cache_.is_valid)
+        {
+            cache_.is_valid = false;
+            mark_dirty();
+        }
+
+        return removed;
+    }
+
+    size_t size() const
+    {
+        return shapes.size();
+    }
+
+    void reserve(size_t capacity)
+    {
+        auto& items = shapes.items_;
+        const any_shape* data = items.data();
+        if (!positions_)
+            positions_ = std::make_unique<PositionTable>();
+        positions_->reserve(capacity);
+        items.reserve(capacity);
+        if (items.data() != data)
+            bind_from(0);
+        cache_.offsets.reserve(capacity + 1);
+        cache_.is_dirty.reserve(capacity);
+    }
+
+    // output of all shapes - only shapes changed since previous call are rendered again
+    // - updates the cache (also through render() and redraw()) - it must not be called concurrently
+    const std::string& rendered() const
+    {
+        if (cache_.is_valid)
+            return cache_.frame;
+
+        if (cache_.needs_full_render)
+        {
+            cache_.frame.clear();
+            for (size_t i = 0; i < shapes.items_.size(); ++i)
+            {
+                cache_.offsets[i] = cache_.frame.size();
+                shapes.items_[i]->render(cache_.frame);
+            }
+            cache_.offsets[shapes.items_.size()] = cache_.frame.size();
+
+            for (uint32_t index : cache_.dirty_children)
+                cache_.is_dirty[index] = false;
+            cache_.dirty_children.clear();
+            cache_.needs_full_render = false;
+            cache_.is_valid = true;
+
+            return cache_.frame;
+        }
+
+        auto& dirty = cache_.dirty_children;
+        std::sort(dirty.begin(), dirty.end());
+
+        std::string updates;
+        std::vector<size_t> update_offsets{0};
+        update_offsets.reserve(dirty.size() + 1);
+        bool same_sizes = true;
+        for (uint32_t index : dirty)
+        {
+            cache_.is_dirty[index] = false;
+            shapes.items_[index]->render(updates);
+            update_offsets.push_back(updates.size());
+            same_sizes = same_sizes && updates.size() - update_offsets[update_offsets.size() - 2] == cache_.output_size(index);
+        }
+
+        if (same_sizes) // outputs are patched in place
+        {
+            for (size_t i = 0; i < dirty.size(); ++i)
+                updates.copy(cache_.frame.data() + cache_.offsets[dirty[i]], update_offsets[i + 1] - update_offsets[i], update_offsets[i]);
+        }
+        else // unchanged outputs are copied to the new frame in runs between changed shapes
+        {
+            std::string frame;
+            frame.reserve(cache_.frame.size() + updates.size());
+
+            size_t next_shape = 0;
+            size_t old_begin = 0; // offset of next_shape's output in the old frame
+            for (size_t i = 0; i <= dirty.size(); ++i)
+            {
+                const size_t last_shape = i < dirty.size() ? dirty[i] : shapes.items_.size();
+                const size_t old_end = cache_.offsets[last_shape];
+                const size_t new_begin = frame.size();
+                frame.append(cache_.frame, old_begin, old_end - old_begin);
+                for (size_t s = next_shape; s <= last_shape; ++s)
+                    cache_.offsets[s] = cache_.offsets[s] - old_begin + new_begin;
+
+                if (i < dirty.size())
+                {
+                    frame.append(updates, update_offsets[i], update_offsets[i + 1] - update_offsets[i]);
+                    next_shape = last_shape + 1;
+                    old_begin = cache_.offsets[next_shape];
+                }
+            }
+
+            cache_.frame = std::move(frame);
+        }
+
+        dirty.clear();
+        cache_.is_valid = true;
+
+        return cache_.frame;
+    }
+
+    void render(std::string& output) const override
+    {
+        output += rendered();
+    }
+
+    // incremental draw - output is the same as output of draw()
+    void redraw() const
+    {
+        const std::string& frame = rendered();
+        std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        std::cout.flush();
+    }
+
+    // optional inverted index of words in texts of shapes (nested groups are not searched)
+    // - it is updated by add() and when text of a shape changes (Text::set_text())
+    void enable_text_index()
+    {
+        text_index_ = std::make_unique<TextIndex>();
+        for (size_t i = 0; i < shapes.items_.size(); ++i)
+            text_index_->update(static_cast<uint32_t>(i), shapes.items_[i]->searchable_text());
+    }
+
+    bool has_text_index() const
+    {
+        return text_index_ != nullptr;
+    }
+
+    // indexes of shapes containing all words - in order of shapes
+    std::vector<size_t> find_all(const std::vector<std::string_view>& words) const
+    {
+        return search([&words](const TextIndex& index) { return index.find_all(words); });
+    }
+
+    // indexes of shapes containing any of words - in order of shapes
+    std::vector<size_t> find_any(const std::vector<std::string_view>& words) const
+    {
+        return search([&words](const TextIndex& index) { return index.find_any(words); });
+    }
+
+    // transforms of positions of all Text shapes in the group and nested groups
+    // - positions are kept in SoA PositionTables and transformed with SIMD kernels
+    // - other kinds of shapes are not affected
+    void translate(int dx, int dy)
+    {
+        transform_positions([=](PositionTable& table) { table.translate(dx, dy); });
+    }
+
+    void scale(float factor, int origin_x = 0, int origin_y = 0)
+    {
+        transform_positions([=](PositionTable& table) { table.scale(factor, origin_x, origin_y); });
+    }
+
+    void clamp(const Rect& area)
+    {
+        transform_positions([&](PositionTable& table) { table.clamp(area); });
+    }
+
+    // optional uniform grid index used by query() and draw_in()
+    void enable_spatial_index(int cell_size = 64)
+    {
+        index_ = std::make_unique<UniformGrid>(cell_size);
+        for (size_t i = 0; i < shapes.items_.size(); ++i)
+            index_->insert(static_cast<uint32_t>(i), shapes.items_[i]->bounds());
+    }
+
+    bool has_spatial_index() const
+    {
+        return index_ != nullptr;
+    }
+
+    // updates spatial index after the shape at index was moved
+    void reindex(size_t index)
+    {
+        if (index_)
+            index_->update(static_cast<uint32_t>(index), shapes.items_[index]->bounds());
+    }
+
+    // indexes of shapes intersecting area - in order of shapes
+    std::vector<size_t> query(const Rect& area) const
+    {
+        std::vector<size_t> result;
+
+        if (index_)
+        {
+            for (uint32_t id : index_->query(area))
+                result.push_back(id);
+        }
+        else
+        {
+            for (size_t i = 0; i < shapes.items_.size(); ++i)
+                if (shapes.items_[i]->bounds().intersects(area))
+                    result.push_back(i);
+        }
+
+        return result;
+    }
+
+    void record_in(const Rect& area, RenderCommandBuffer& buffer) const
+    {
+        for (size_t i : query(area))
+            shapes.items_[i]->record(buffer);
+    }
+
+    // draws only shapes visible in viewport
+    void draw_in(const Rect& viewport) const
+    {
+        RenderCommandBuffer buffer;
+        record_in(viewport, buffer);
+        buffer.execute(std::cout);
+    }
+
+private:
+    struct RenderCache
+    {
+        std::string frame; // outputs of all shapes - output of shape i is [offsets[i], offsets[i + 1])
+        std::vector<size_t> offsets{0};
+        std::vector<bool> is_dirty;
+        std::vector<uint32_t> dirty_children;
+        bool is_valid = false;
+        bool needs_full_render = true; // nothing was rendered yet or all positions changed
+
+        size_t output_size(size_t index) const
+        {
+            return offsets[index + 1] - offsets[index];
+        }
+    };
+
+    std::unique_ptr<PositionTable> positions_; // reset first by the destructor - shapes do not release their slots
+    std::unique_ptr<UniformGrid> index_;
+    std::unique_ptr<TextIndex> text_index_;
+    std::vector<uint32_t> subgroups_; // indexes of nested groups
+    mutable RenderCache cache_;
+
+    friend class Shape;
+
+    void add(any_shape shape, bool is_group)
+    {
+        auto& items = shapes.items_;
+        const auto index = static_cast<uint32_t>(items.size());
+        const any_shape* data = items.data();
+        if (is_group)
+            subgroups_.push_back(index);
+        items.push_back(std::move(shape));
+        bind_from(items.data() == data ? index : 0); // shapes stored inline were moved to the new buffer
+
+        if (index_)
+            index_->insert(index, items.back().bounds());
+        if (text_index_)
+            text_index_->update(index, items.back()->searchable_text());
+
+        cache_.offsets.push_back(cache_.offsets.back());
+        cache_.is_dirty.push_back(false);
+        child_changed(index);
+    }
+
+    void child_changed(uint32_t index)
+    {
+        if (index_)
+            reindex(index);
+        if (text_index_)
+            text_index_->update(index, shapes.items_[index]->searchable_text());
+
+        // full render renders every shape - changes are not tracked until then
+        if (!cache_.needs_full_render && !cache_.is_dirty[index])
+        {
+            cache_.is_dirty[index] = true;
+            cache_.dirty_children.push_back(index);
+        }
+
+        if (cache_.is_valid)
+        {
+            cache_.is_valid = false;
+            mark_dirty();
+        }
+    }
+
+    // without the text index all shapes are scanned into a temporary one
+    template <typename TQuery>
+    std::vector<size_t> search(TQuery query) const
+    {
+        std::vector<uint32_t> ids;
+        if (text_index_)
+            ids = query(*text_index_);
+        else
+        {
+            TextIndex scan;
+            for (size_t i = 0; i < shapes.items_.size(); ++i)
+                scan.update(static_cast<uint32_t>(i), shapes.items_[i]->searchable_text());
+            ids = query(scan);
+        }
+
+        return std::vector<size_t>(ids.begin(), ids.end());
+    }
+
+    template <typename TTransform>
+    void transform_positions(TTransform transform)
+    {
+        if (positions_)
+            transform(*positions_);
+        for (uint32_t index : subgroups_)
+            static_cast<ShapeGroup&>(*shapes.items_[index]).transform_positions(transform);
+
+        if (index_)
+        {
+            for (size_t i = 0; i < shapes.items_.size(); ++i)
+                reindex(i);
+        }
+
+        cache_.needs_full_render = true;
+        if (cache_.is_valid)
+        {
+            cache_.is_valid = false;
+            mark_dirty();
+        }
+    }
+
+    void adopt_children()
+    {
+        for (auto& s : shapes.items_)
+            s->parent_ = this;
+    }
+
+    // binds shapes from first on that are not bound to the group - shapes added or moved in the list
+    void bind_from(size_t first)
+    {
+        if (!positions_)
+            positions_ = std::make_unique<PositionTable>();
+
+        auto& items = shapes.items_;
+        for (size_t i = first; i < items.size(); ++i)
+        {
+            Shape& shape = *items[i];
+            if (shape.parent_ != this)
+            {
+                shape.parent_ = this;
+                shape.bind_position(*positions_);
+            }
+            shape.index_in_parent_ = static_cast<uint32_t>(i);
+        }
+    }
+};
+
+inline void draw_shape(const Shape& shape, std::ostream& out)
+{
+    shape.draw_to(out);
+}
+
+inline PositionTable* Shape::position_table() const
+{
+    return parent_ ? parent_->positions_.get() : nullptr;
+}
+
+inline void Shape::mark_dirty()
+{
+    if (parent_)
+        parent_->child_changed(index_in_parent_);
+}
+
 #endif /*PARAGRAPH_HPP_*/
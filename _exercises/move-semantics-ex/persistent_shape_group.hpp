@@ -0,0 +1,242 @@
+#ifndef PERSISTENT_SHAPE_GROUP_HPP_
+#define PERSISTENT_SHAPE_GROUP_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "paragraph.hpp"
+
+// Group of immutable shapes stored in a persistent 32-way tree
+// - copy (snapshot) is O(1) - copies share the tree
+// - set() and add() copy only the path from the root to the changed leaf - O(log n),
+//   unchanged shapes and subtrees are shared between versions
+// - shapes are immutable - to edit a shape modify() replaces it with a changed copy
+class PersistentShapeGroup : public Shape
+{
+public:
+    static constexpr size_t bits = 5;
+    static constexpr size_t branching = size_t{1} << bits;
+
+private:
+    // leaves hold shared_ptr<const Shape>, inner nodes shared_ptr<const Node> - both stored as shared_ptr<const void>
+    struct Node
+    {
+        std::array<std::shared_ptr<const void>, branching> slots;
+    };
+
+    std::shared_ptr<const Node> root_;
+    size_t size_ = 0;
+    size_t shift_ = 0; // bits of index consumed above leaves
+
+public:
+    PersistentShapeGroup() = default;
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    const Shape& operator[](size_t index) const
+    {
+        return *shared(index);
+    }
+
+    std::shared_ptr<const Shape> shared(size_t index) const
+    {
+        assert(index < size_);
+
+        const Node* node = root_.get();
+        for (size_t level = shift_; level > 0; level -= bits)
+            node = static_cast<const Node*>(node->slots[(index >> level) % branching].get());
+        return std::static_pointer_cast<const Shape>(node->slots[index % branching]);
+    }
+
+    void add(std::shared_ptr<const Shape> shape)
+    {
+        if (root_ && size_ == (size_t{1} << (shift_ + bits)))
+        {
+            auto new_root = std::make_shared<Node>();
+            new_root->slots[0] = std::move(root_);
+            root_ = std::move(new_root);
+            shift_ += bits;
+        }
+
+        root_ = with_shape(root_.get(), shift_, size_, std::move(shape));
+        ++size_;
+    }
+
+    template <typename TShape, typename... TArgs>
+    void emplace(TArgs&&... args)
+    {
+        add(std::make_shared<const TShape>(std::forward<TArgs>(args)...));
+    }
+
+    void set(size_t index, std::shared_ptr<const Shape> shape)
+    {
+        assert(index < size_);
+        root_ = with_shape(root_.get(), shift_, index, std::move(shape));
+    }
+
+    // replaces shape at index with its copy changed by f(TShape&)
+    template <typename TShape, typename F>
+    void modify(size_t index, F&& f)
+    {
+        auto copy = std::make_shared<TShape>(static_cast<const TShape&>((*this)[index]));
+        f(*copy);
+        set(index, std::move(copy));
+    }
+
+    // calls f(const Shape&) for shapes in order
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        if (root_)
+            for_each_in(*root_, shift_, f);
+    }
+
+    void draw() const override
+    {
+        RenderCommandBuffer buffer;
+        record(buffer);
+        buffer.execute(std::cout);
+    }
+
+    void record(RenderCommandBuffer& buffer) const override
+    {
+        for_each([&buffer](const Shape& shape) { shape.record(buffer); });
+    }
+
+    Rect bounds() const override
+    {
+        Rect result;
+        for_each([&result](const Shape& shape) { result = result.united(shape.bounds()); });
+        return result;
+    }
+
+    // nodes of the tree - versions sharing nodes are counted once by the caller
+    template <typename F>
+    void visit_nodes(F&& f) const
+    {
+        if (root_)
+            visit_nodes_in(root_.get(), shift_, f);
+    }
+
+private:
+    // copy of node with shape at index - missing nodes on the path are created
+    static std::shared_ptr<const Node> with_shape(const Node* node, size_t level, size_t index, std::shared_ptr<const Shape> shape)
+    {
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        auto& slot = copy->slots[(index >> level) % branching];
+
+        if (level == 0)
+            slot = std::move(shape);
+        else
+            slot = with_shape(static_cast<const Node*>(slot.get()), level - bits, index, std::move(shape));
+
+        return copy;
+    }
+
+    template <typename F>
+    static void for_each_in(const Node& node, size_t level, F& f)
+    {
+        for (const auto& slot : node.slots)
+        {
+            if (!slot)
+                return;
+            if (level == 0)
+                f(*static_cast<const Shape*>(slot.get()));
+            else
+                for_each_in(*static_cast<const Node*>(slot.get()), level - bits, f);
+        }
+    }
+
+    template <typename F>
+    static void visit_nodes_in(const void* node, size_t level, F& f)
+    {
+        f(node);
+        if (level == 0)
+            return;
+        for (const auto& slot : static_cast<const Node*>(node)->slots)
+            if (slot)
+                visit_nodes_in(slot.get(), level - bits, f);
+    }
+};
+
+// Undo/redo stacks of versions of a value with cheap copies (e.g. PersistentShapeGroup)
+template <typename TState>
+class UndoHistory
+{
+    TState current_;
+    std::vector<TState> undo_;
+    std::vector<TState> redo_;
+
+public:
+    explicit UndoHistory(TState initial = TState{})
+        : current_{std::move(initial)}
+    {
+    }
+
+    const TState& current() const
+    {
+        return current_;
+    }
+
+    // next version becomes current - redo stack is cleared
+    void commit(TState next)
+    {
+        undo_.push_back(std::exchange(current_, std::move(next)));
+        redo_.clear();
+    }
+
+    bool undo()
+    {
+        if (undo_.empty())
+            return false;
+
+        redo_.push_back(std::exchange(current_, std::move(undo_.back())));
+        undo_.pop_back();
+        return true;
+    }
+
+    bool redo()
+    {
+        if (redo_.empty())
+            return false;
+
+        undo_.push_back(std::exchange(current_, std::move(redo_.back())));
+        redo_.pop_back();
+        return true;
+    }
+
+    size_t undo_depth() const
+    {
+        return undo_.size();
+    }
+
+    size_t redo_depth() const
+    {
+        return redo_.size();
+    }
+
+    // calls f(const TState&) for all versions
+    template <typename F>
+    void for_each_version(F&& f) const
+    {
+        for (const auto& state : undo_)
+            f(state);
+        f(current_);
+        for (const auto& state : redo_)
+            f(state);
+    }
+};
+
+#endif /*PERSISTENT_SHAPE_GROUP_HPP_*/
@@ -0,0 +1,165 @@
+#ifndef POSITION_TABLE_HPP_
+#define POSITION_TABLE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "geometry.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define POSITION_KERNELS_SSE2 1
+#endif
+
+// Kernels transforming arrays of coordinates
+// - SSE2 kernels process 4 values per instruction, scalar loops handle the tail (and targets without SSE2)
+// - scalar and SSE2 versions give identical results - integer arithmetic wraps around on overflow,
+//   results of scale() out of range of int are INT_MIN (as conversion of SSE2)
+namespace PositionKernels
+{
+    inline void translate(int* values, size_t count, int delta)
+    {
+        size_t i = 0;
+#ifdef POSITION_KERNELS_SSE2
+        const __m128i d = _mm_set1_epi32(delta);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(values + i);
+            _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), d));
+        }
+#endif
+        for (; i < count; ++i)
+            values[i] = static_cast<int>(static_cast<uint32_t>(values[i]) + static_cast<uint32_t>(delta));
+    }
+
+    // value = origin + (value - origin) * factor - computed in float and rounded to nearest (ties to even)
+    inline void scale(int* values, size_t count, float factor, int origin)
+    {
+        size_t i = 0;
+#ifdef POSITION_KERNELS_SSE2
+        const __m128i o = _mm_set1_epi32(origin);
+        const __m128 f = _mm_set1_ps(factor);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(values + i);
+            const __m128 offset = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_loadu_si128(p), o));
+            _mm_storeu_si128(p, _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(offset, f)), o));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            const auto offset = static_cast<int>(static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(origin));
+            const float scaled = std::nearbyint(static_cast<float>(offset) * factor);
+            const int result = (scaled >= -2147483648.0f && scaled < 2147483648.0f) ? static_cast<int>(scaled) : std::numeric_limits<int>::min();
+            values[i] = static_cast<int>(static_cast<uint32_t>(result) + static_cast<uint32_t>(origin));
+        }
+    }
+
+    // lo <= hi
+    inline void clamp(int* values, size_t count, int lo, int hi)
+    {
+        size_t i = 0;
+#ifdef POSITION_KERNELS_SSE2
+        // SSE2 has no 32-bit min/max - values are selected with comparison masks
+        const __m128i l = _mm_set1_epi32(lo);
+        const __m128i h = _mm_set1_epi32(hi);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(values + i);
+            __m128i v = _mm_loadu_si128(p);
+            __m128i mask = _mm_cmplt_epi32(v, l);
+            v = _mm_or_si128(_mm_and_si128(mask, l), _mm_andnot_si128(mask, v));
+            mask = _mm_cmpgt_epi32(v, h);
+            v = _mm_or_si128(_mm_and_si128(mask, h), _mm_andnot_si128(mask, v));
+            _mm_storeu_si128(p, v);
+        }
+#endif
+        for (; i < count; ++i)
+            values[i] = std::clamp(values[i], lo, hi);
+    }
+}
+
+// Positions of shapes in structure-of-arrays form - x and y coordinates in separate contiguous arrays
+// - shapes refer to their slot, so the whole table is transformed without touching the shapes
+// - erased slots are reused by insert() (free slots are transformed too - their values are ignored)
+class PositionTable
+{
+    std::vector<int> xs_;
+    std::vector<int> ys_;
+    std::vector<uint32_t> free_slots_;
+
+public:
+    uint32_t insert(int x, int y)
+    {
+        if (!free_slots_.empty())
+        {
+            const uint32_t slot = free_slots_.back();
+            free_slots_.pop_back();
+            set(slot, x, y);
+            return slot;
+        }
+
+        xs_.push_back(x);
+        ys_.push_back(y);
+        return static_cast<uint32_t>(xs_.size() - 1);
+    }
+
+    void erase(uint32_t slot)
+    {
+        free_slots_.push_back(slot);
+    }
+
+    // number of slots in use
+    size_t size() const
+    {
+        return xs_.size() - free_slots_.size();
+    }
+
+    void reserve(size_t capacity)
+    {
+        xs_.reserve(capacity);
+        ys_.reserve(capacity);
+    }
+
+    int x(uint32_t slot) const
+    {
+        return xs_[slot];
+    }
+
+    int y(uint32_t slot) const
+    {
+        return ys_[slot];
+    }
+
+    void set(uint32_t slot, int x, int y)
+    {
+        xs_[slot] = x;
+        ys_[slot] = y;
+    }
+
+    void translate(int dx, int dy)
+    {
+        PositionKernels::translate(xs_.data(), xs_.size(), dx);
+        PositionKernels::translate(ys_.data(), ys_.size(), dy);
+    }
+
+    // coordinates are computed in float - exact only for offsets from origin up to 2^24
+    void scale(float factor, int origin_x = 0, int origin_y = 0)
+    {
+        PositionKernels::scale(xs_.data(), xs_.size(), factor, origin_x);
+        PositionKernels::scale(ys_.data(), ys_.size(), factor, origin_y);
+    }
+
+    // moves positions into area - area must not be empty
+    void clamp(const Rect& area)
+    {
+        PositionKernels::clamp(xs_.data(), xs_.size(), area.left, area.right - 1);
+        PositionKernels::clamp(ys_.data(), ys_.size(), area.top, area.bottom - 1);
+    }
+};
+
+#endif /*POSITION_TABLE_HPP_*/
@@ -0,0 +1,193 @@
+#ifndef RENDER_COMMANDS_HPP_
+#define RENDER_COMMANDS_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Shape;
+
+enum class RenderOpcode : uint8_t {
+    Text,
+    Draw // draws a shape that does not record its own commands
+};
+
+struct RenderCommand
+{
+    RenderOpcode opcode;
+    int x, y;
+    uint32_t text_offset; // handle of text stored in the buffer's arena
+    uint32_t text_length;
+    uint32_t shape_index; // shape drawn by Draw
+};
+
+// writes output of the shape to out (Shape::draw_to()) - defined with Shape in paragraph.hpp
+void draw_shape(const Shape& shape, std::ostream& out);
+
+// Flat buffer of recorded render commands
+// - texts are copied into a single arena, commands refer to them by offset
+// - recording does not produce any output - execute() renders all commands with one write,
+//   so a buffer can be deferred, sorted, merged or replayed
+// - Draw commands refer to their shapes - the buffer must not be executed after the shapes are destroyed
+class RenderCommandBuffer
+{
+    std::vector<RenderCommand> commands_;
+    std::vector<char> text_arena_;
+    std::vector<const Shape*> drawn_shapes_;
+
+public:
+    void record_text(int x, int y, std::string_view text)
+    {
+        const auto offset = static_cast<uint32_t>(text_arena_.size());
+        text_arena_.insert(text_arena_.end(), text.begin(), text.end());
+        commands_.push_back(RenderCommand{RenderOpcode::Text, x, y, offset, static_cast<uint32_t>(text.size()), 0});
+    }
+
+    // appends chunk to text of the last recorded Text command - text stored in chunks (e.g. in a rope)
+    // is recorded without flattening it first
+    void append_text(std::string_view chunk)
+    {
+        assert(!commands_.empty() && commands_.back().opcode == RenderOpcode::Text);
+        text_arena_.insert(text_arena_.end(), chunk.begin(), chunk.end());
+        commands_.back().text_length += static_cast<uint32_t>(chunk.size());
+    }
+
+    void record_draw(const Shape& shape)
+    {
+        commands_.push_back(RenderCommand{RenderOpcode::Draw, 0, 0, 0, 0, static_cast<uint32_t>(drawn_shapes_.size())});
+        drawn_shapes_.push_back(&shape);
+    }
+
+    const std::vector<RenderCommand>& commands() const
+    {
+        return commands_;
+    }
+
+    std::string_view text(const RenderCommand& command) const
+    {
+        return std::string_view{text_arena_.data() + command.text_offset, command.text_length};
+    }
+
+    size_t size() const
+    {
+        return commands_.size();
+    }
+
+    bool empty() const
+    {
+        return commands_.empty();
+    }
+
+    void clear()
+    {
+        commands_.clear();
+        text_arena_.clear();
+        drawn_shapes_.clear();
+    }
+
+    void reserve(size_t no_of_commands, size_t text_bytes)
+    {
+        commands_.reserve(no_of_commands);
+        text_arena_.reserve(text_bytes);
+    }
+
+    // appends commands of other buffer after commands of this buffer
+    void append(const RenderCommandBuffer& other)
+    {
+        const auto offset = static_cast<uint32_t>(text_arena_.size());
+        const auto shape_offset = static_cast<uint32_t>(drawn_shapes_.size());
+        text_arena_.insert(text_arena_.end(), other.text_arena_.begin(), other.text_arena_.end());
+        drawn_shapes_.insert(drawn_shapes_.end(), other.drawn_shapes_.begin(), other.drawn_shapes_.end());
+
+        commands_.reserve(commands_.size() + other.commands_.size());
+        for (RenderCommand command : other.commands_)
+        {
+            if (command.opcode == RenderOpcode::Draw)
+                command.shape_index += shape_offset;
+            else
+                command.text_offset += offset;
+            commands_.push_back(command);
+        }
+    }
+
+    // stable sort - top to bottom, left to right (Draw commands are sorted as [0, 0])
+    void sort_by_position()
+    {
+        std::stable_sort(commands_.begin(), commands_.end(), [](const RenderCommand& a, const RenderCommand& b) {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        });
+    }
+
+    // shapes of Draw commands are drawn to a string stream - see Shape::draw_to()
+    void render(std::string& output) const
+    {
+        std::ostringstream drawn;
+
+        for (const auto& command : commands_)
+        {
+            switch (command.opcode)
+            {
+            case RenderOpcode::Text:
+                render_text(command, output);
+                break;
+            case RenderOpcode::Draw:
+                drawn.str({});
+                draw_shape(*drawn_shapes_[command.shape_index], drawn);
+                output += drawn.view();
+                break;
+            }
+        }
+    }
+
+    // output between Draw commands is written with one write - shapes of Draw commands are drawn directly to out
+    void execute(std::ostream& out) const
+    {
+        std::string output;
+        output.reserve(text_arena_.size() + commands_.size() * 40);
+
+        for (const auto& command : commands_)
+        {
+            switch (command.opcode)
+            {
+            case RenderOpcode::Text:
+                render_text(command, output);
+                break;
+            case RenderOpcode::Draw:
+                out.write(output.data(), static_cast<std::streamsize>(output.size()));
+                output.clear();
+                draw_shape(*drawn_shapes_[command.shape_index], out);
+                break;
+            }
+        }
+
+        out.write(output.data(), static_cast<std::streamsize>(output.size()));
+        out.flush();
+    }
+
+private:
+    void render_text(const RenderCommand& command, std::string& output) const
+    {
+        output += "Rendering text '";
+        output += text(command);
+        output += "' at: [";
+        append_number(output, command.x);
+        output += ", ";
+        append_number(output, command.y);
+        output += "]\n";
+    }
+
+    static void append_number(std::string& output, int value)
+    {
+        char digits[16];
+        auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), value);
+        output.append(digits, end);
+    }
+};
+
+#endif /*RENDER_COMMANDS_HPP_*/
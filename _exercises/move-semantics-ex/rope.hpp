@@ -0,0 +1,423 @@
+#ifndef ROPE_HPP_
+#define ROPE_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Text stored as a balanced (AVL) tree of chunks
+// - insert, erase and substr cost O(log n) plus the size of the inserted/extracted text
+// - small inserts go directly into a leaf chunk while it has room
+// - c_str() flattens the text lazily and caches it until the next edit - const access never flattens
+class Rope
+{
+public:
+    static constexpr size_t max_chunk_size = 1024;
+
+private:
+    struct Node
+    {
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+        std::string chunk; // only in leaves
+        size_t length = 0;
+        int height = 1;
+
+        bool is_leaf() const
+        {
+            return left == nullptr;
+        }
+    };
+
+    using NodePtr = std::unique_ptr<Node>;
+
+    NodePtr root_;
+    std::string flat_;
+    bool is_flat_valid_ = false;
+
+public:
+    static constexpr size_t npos = std::string_view::npos;
+
+    Rope() = default;
+
+    explicit Rope(std::string_view text)
+        : root_{build(text)}
+    {
+    }
+
+    Rope(const Rope& source)
+        : root_{clone(source.root_.get())}
+    {
+    }
+
+    Rope& operator=(const Rope& source)
+    {
+        if (this != &source)
+        {
+            root_ = clone(source.root_.get());
+            invalidate();
+        }
+        return *this;
+    }
+
+    Rope(Rope&&) noexcept = default;
+    Rope& operator=(Rope&&) noexcept = default;
+
+    size_t size() const
+    {
+        return length(root_.get());
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    void assign(std::string_view text)
+    {
+        root_ = build(text);
+        invalidate();
+    }
+
+    // pos <= size()
+    void insert(size_t pos, std::string_view text)
+    {
+        assert(pos <= size());
+
+        if (text.empty())
+            return;
+
+        invalidate();
+
+        if (root_ && insert_into_leaf(*root_, pos, text))
+            return;
+
+        auto [left, right] = split(std::move(root_), pos);
+        root_ = join(join(std::move(left), build(text)), std::move(right));
+    }
+
+    // erases at most count chars starting at pos <= size()
+    void erase(size_t pos, size_t count)
+    {
+        assert(pos <= size());
+
+        count = std::min(count, size() - pos);
+        if (count == 0)
+            return;
+
+        invalidate();
+
+        auto [left, rest] = split(std::move(root_), pos);
+        auto [erased, right] = split(std::move(rest), count);
+        root_ = join(std::move(left), std::move(right));
+    }
+
+    // at most count chars starting at pos <= size()
+    std::string substr(size_t pos, size_t count) const
+    {
+        assert(pos <= size());
+
+        std::string result;
+        result.reserve(std::min(count, size() - pos));
+        for_each_chunk_in(root_.get(), pos, count, [&result](std::string_view chunk) { result += chunk; });
+        return result;
+    }
+
+    // calls f(std::string_view) for chunks of the text in order
+    template <typename F>
+    void for_each_chunk(F&& f) const
+    {
+        for_each_chunk_in(root_.get(), 0, size(), f);
+    }
+
+    std::string str() const
+    {
+        return substr(0, size());
+    }
+
+    // flattened text - valid until the next edit
+    const char* c_str()
+    {
+        if (!is_flat_valid_)
+        {
+            flat_ = str();
+            is_flat_valid_ = true;
+        }
+        return flat_.c_str();
+    }
+
+    // text flattened by c_str() - nullptr when the rope was edited since
+    const char* flattened() const
+    {
+        return is_flat_valid_ ? flat_.c_str() : nullptr;
+    }
+
+    // position of the first c at or after pos or npos
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= size())
+            return npos;
+
+        size_t result = npos;
+        size_t offset = pos;
+        for_each_chunk_in(root_.get(), pos, size() - pos, [&](std::string_view chunk) {
+            if (result != npos)
+                return;
+            if (const size_t i = chunk.find(c); i != npos)
+                result = offset + i;
+            offset += chunk.size();
+        });
+        return result;
+    }
+
+    // position of the first occurrence of text at or after pos or npos
+    // - chunks are searched with the last text.size() - 1 chars of previous chunks in front of them
+    size_t find(std::string_view text, size_t pos = 0) const
+    {
+        if (pos > size())
+            return npos;
+        if (text.empty())
+            return pos;
+
+        std::string window;
+        size_t window_pos = pos; // position of window[0] in the rope
+        size_t result = npos;
+        for_each_chunk_in(root_.get(), pos, size() - pos, [&](std::string_view chunk) {
+            if (result != npos)
+                return;
+
+            window += chunk;
+            if (const size_t i = window.find(text); i != npos)
+            {
+                result = window_pos + i;
+                return;
+            }
+
+            const size_t dropped = window.size() - std::min(window.size(), text.size() - 1);
+            window.erase(0, dropped);
+            window_pos += dropped;
+        });
+        return result;
+    }
+
+    int height() const
+    {
+        return height(root_.get());
+    }
+
+private:
+    void invalidate()
+    {
+        is_flat_valid_ = false;
+    }
+
+    static size_t length(const Node* node)
+    {
+        return node ? node->length : 0;
+    }
+
+    static int height(const Node* node)
+    {
+        return node ? node->height : 0;
+    }
+
+    static NodePtr make_leaf(std::string_view text)
+    {
+        auto leaf = std::make_unique<Node>();
+        leaf->chunk = text;
+        leaf->length = text.size();
+        return leaf;
+    }
+
+    static NodePtr make_node(NodePtr left, NodePtr right)
+    {
+        auto node = std::make_unique<Node>();
+        node->left = std::move(left);
+        node->right = std::move(right);
+        update(*node);
+        return node;
+    }
+
+    static void update(Node& node)
+    {
+        node.length = length(node.left.get()) + length(node.right.get());
+        node.height = 1 + std::max(height(node.left.get()), height(node.right.get()));
+    }
+
+    // balanced tree of chunks of max_chunk_size
+    static NodePtr build(std::string_view text)
+    {
+        if (text.empty())
+            return nullptr;
+        if (text.size() <= max_chunk_size)
+            return make_leaf(text);
+
+        const size_t no_of_chunks = (text.size() + max_chunk_size - 1) / max_chunk_size;
+        const size_t middle = (no_of_chunks / 2) * max_chunk_size;
+        return make_node(build(text.substr(0, middle)), build(text.substr(middle)));
+    }
+
+    static NodePtr clone(const Node* node)
+    {
+        if (node == nullptr)
+            return nullptr;
+
+        auto copy = std::make_unique<Node>();
+        copy->left = clone(node->left.get());
+        copy->right = clone(node->right.get());
+        copy->chunk = node->chunk;
+        copy->length = node->length;
+        copy->height = node->height;
+        return copy;
+    }
+
+    static bool insert_into_leaf(Node& node, size_t pos, std::string_view text)
+    {
+        if (node.is_leaf())
+        {
+            if (node.chunk.size() + text.size() > max_chunk_size)
+                return false;
+            node.chunk.insert(pos, text);
+        }
+        else
+        {
+            const size_t left_length = length(node.left.get());
+            const bool inserted = (pos <= left_length)
+                ? insert_into_leaf(*node.left, pos, text)
+                : insert_into_leaf(*node.right, pos - left_length, text);
+            if (!inserted)
+                return false;
+        }
+
+        node.length += text.size();
+        return true;
+    }
+
+    static NodePtr rotate_left(NodePtr node)
+    {
+        NodePtr pivot = std::move(node->right);
+        node->right = std::move(pivot->left);
+        update(*node);
+        pivot->left = std::move(node);
+        update(*pivot);
+        return pivot;
+    }
+
+    static NodePtr rotate_right(NodePtr node)
+    {
+        NodePtr pivot = std::move(node->left);
+        node->left = std::move(pivot->right);
+        update(*node);
+        pivot->right = std::move(node);
+        update(*pivot);
+        return pivot;
+    }
+
+    static NodePtr rebalance(NodePtr node)
+    {
+        update(*node);
+        const int balance = height(node->left.get()) - height(node->right.get());
+
+        if (balance > 1)
+        {
+            if (height(node->left->left.get()) < height(node->left->right.get()))
+                node->left = rotate_left(std::move(node->left));
+            return rotate_right(std::move(node));
+        }
+        if (balance < -1)
+        {
+            if (height(node->right->right.get()) < height(node->right->left.get()))
+                node->right = rotate_right(std::move(node->right));
+            return rotate_left(std::move(node));
+        }
+        return node;
+    }
+
+    // concatenation - O(difference of heights)
+    static NodePtr join(NodePtr left, NodePtr right)
+    {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+
+        if (left->is_leaf() && right->is_leaf() && left->length + right->length <= max_chunk_size)
+        {
+            left->chunk += right->chunk;
+            left->length = left->chunk.size();
+            return left;
+        }
+
+        if (left->height > right->height + 1)
+        {
+            left->right = join(std::move(left->right), std::move(right));
+            return rebalance(std::move(left));
+        }
+        if (right->height > left->height + 1)
+        {
+            right->left = join(std::move(left), std::move(right->left));
+            return rebalance(std::move(right));
+        }
+        return make_node(std::move(left), std::move(right));
+    }
+
+    // first pos chars and the rest
+    static std::pair<NodePtr, NodePtr> split(NodePtr node, size_t pos)
+    {
+        if (!node)
+            return {nullptr, nullptr};
+        if (pos == 0)
+            return {nullptr, std::move(node)};
+        if (pos >= node->length)
+            return {std::move(node), nullptr};
+
+        if (node->is_leaf())
+        {
+            auto right = make_leaf(std::string_view{node->chunk}.substr(pos));
+            node->chunk.resize(pos);
+            node->length = pos;
+            return {std::move(node), std::move(right)};
+        }
+
+        const size_t left_length = length(node->left.get());
+        if (pos < left_length)
+        {
+            auto [first, second] = split(std::move(node->left), pos);
+            return {std::move(first), join(std::move(second), std::move(node->right))};
+        }
+        if (pos > left_length)
+        {
+            auto [first, second] = split(std::move(node->right), pos - left_length);
+            return {join(std::move(node->left), std::move(first)), std::move(second)};
+        }
+        return {std::move(node->left), std::move(node->right)};
+    }
+
+    template <typename F>
+    static void for_each_chunk_in(const Node* node, size_t pos, size_t count, F&& f)
+    {
+        if (node == nullptr || count == 0 || pos >= node->length)
+            return;
+
+        if (node->is_leaf())
+        {
+            f(std::string_view{node->chunk}.substr(pos, count));
+            return;
+        }
+
+        const size_t left_length = length(node->left.get());
+        if (pos < left_length)
+        {
+            for_each_chunk_in(node->left.get(), pos, count, f);
+            const size_t taken = std::min(count, left_length - pos);
+            for_each_chunk_in(node->right.get(), 0, count - taken, f);
+        }
+        else
+            for_each_chunk_in(node->right.get(), pos - left_length, count, f);
+    }
+};
+
+#endif /*ROPE_HPP_*/
@@ -0,0 +1,271 @@
+#ifndef SCENE_FILE_HPP_
+#define SCENE_FILE_HPP_
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h> // min/max macros are disabled by NOMINMAX set in CMakeLists.txt
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "paragraph.hpp"
+
+// Binary scene file (version 1, little-endian):
+//   SceneHeader | SceneRecord[record_count] | text region
+// - records of a group are stored in pre-order - a group record is followed by the records of its subtree
+// - texts are stored in the text region, every text is followed by '\0'
+namespace SceneFile
+{
+    static_assert(std::endian::native == std::endian::little, "scene files are little-endian");
+
+    constexpr char magic[4] = {'S', 'C', 'N', 'F'};
+    constexpr uint32_t version = 1;
+
+    // groups are drawn, saved, loaded and destroyed recursively - deeper nesting is rejected
+    constexpr size_t max_depth = 256;
+
+    enum class RecordType : uint32_t
+    {
+        text = 1,
+        group = 2
+    };
+
+    struct SceneHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t record_count;
+        uint64_t text_size;
+    };
+
+    struct SceneRecord
+    {
+        RecordType type;
+        int32_t x;
+        int32_t y;
+        uint32_t size;   // text: length of text, group: number of records in the subtree
+        uint64_t offset; // text: offset in the text region
+    };
+
+    static_assert(sizeof(SceneHeader) == 24 && sizeof(SceneRecord) == 24);
+
+    // read-only memory mapping of the whole file
+    class MappedFile
+    {
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::string& path)
+        {
+#ifdef _WIN32
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER size;
+            if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size))
+                throw std::runtime_error("Can not open scene file: " + path);
+            size_ = static_cast<size_t>(size.QuadPart);
+            if (size_ == 0)
+                return;
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr || (data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0))) == nullptr)
+            {
+                close();
+                throw std::runtime_error("Can not map scene file: " + path);
+            }
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (fd < 0 || ::fstat(fd, &info) != 0)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+                throw std::runtime_error("Can not open scene file: " + path);
+            }
+
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_ > 0)
+            {
+                void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Can not map scene file: " + path);
+                }
+                ::madvise(data, size_, MADV_WILLNEED);
+                data_ = static_cast<const char*>(data);
+            }
+            ::close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            close();
+        }
+
+        const char* data() const
+        {
+            return data_;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        void close() noexcept
+        {
+#ifdef _WIN32
+            if (data_)
+                UnmapViewOfFile(data_);
+            if (mapping_)
+                CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                CloseHandle(file_);
+#else
+            if (data_)
+                ::munmap(const_cast<char*>(data_), size_);
+#endif
+            data_ = nullptr;
+        }
+    };
+
+    namespace Detail
+    {
+        inline void append_records(const ShapeGroup& group, std::vector<SceneRecord>& records, std::string& texts, size_t depth = 0)
+        {
+            if (depth >= max_depth)
+                throw std::invalid_argument("Groups nested deeper than " + std::to_string(max_depth) + " levels can not be saved in a scene file");
+
+            for (const auto& shape : group.shapes)
+            {
+                if (const auto* text = dynamic_cast<const Text*>(shape))
+                {
+                    const std::string_view txt = text->searchable_text();
+                    if (txt.size() > std::numeric_limits<uint32_t>::max())
+                        throw std::invalid_argument("Texts longer than 4 GB can not be saved in a scene file");
+                    records.push_back(SceneRecord{RecordType::text, text->x(), text->y(), static_cast<uint32_t>(txt.size()), texts.size()});
+                    texts.append(txt);
+                    texts.push_back('\0');
+                }
+                else if (const auto* nested = dynamic_cast<const ShapeGroup*>(shape))
+                {
+                    const size_t index = records.size();
+                    records.push_back(SceneRecord{RecordType::group, 0, 0, 0, 0});
+                    append_records(*nested, records, texts, depth + 1);
+                    records[index].size = static_cast<uint32_t>(records.size() - index - 1);
+                }
+                else
+                    throw std::invalid_argument("Only Text and ShapeGroup shapes can be saved in a scene file");
+            }
+        }
+
+        // records [first, last) are shapes of group at depth (0 for the loaded group)
+        inline void load_records(const std::shared_ptr<const MappedFile>& file, const SceneRecord* records, size_t first, size_t last,
+            const char* texts, size_t text_size, ShapeGroup& group, size_t depth = 0)
+        {
+            if (depth >= max_depth)
+                throw std::runtime_error("Corrupted scene file - groups nested deeper than " + std::to_string(max_depth) + " levels");
+
+            group.reserve(last - first);
+
+            for (size_t i = first; i < last; ++i)
+            {
+                SceneRecord record;
+                std::memcpy(&record, records + i, sizeof(SceneRecord));
+
+                if (record.type == RecordType::text)
+                {
+                    if (record.offset >= text_size || record.size >= text_size - record.offset || texts[record.offset + record.size] != '\0')
+                        throw std::runtime_error("Corrupted scene file - invalid text");
+
+                    // aliasing shared_ptr - text points into the mapping, the mapping is kept alive by texts
+                    // Text is constructed in place - stored inline in the group, no allocation per shape
+                    std::shared_ptr<const char> txt{file, texts + record.offset};
+                    group.emplace<Text>(record.x, record.y, SharedText{std::move(txt), record.size});
+                }
+                else if (record.type == RecordType::group)
+                {
+                    if (record.size > last - i - 1)
+                        throw std::runtime_error("Corrupted scene file - invalid group");
+
+                    auto& nested = group.emplace<ShapeGroup>();
+                    load_records(file, records, i + 1, i + 1 + record.size, texts, text_size, nested, depth + 1);
+                    i += record.size;
+                }
+                else
+                    throw std::runtime_error("Corrupted scene file - unknown record type");
+            }
+        }
+    }
+
+    // group may contain only Text and ShapeGroup shapes
+    inline void save(const ShapeGroup& group, const std::string& path)
+    {
+        std::vector<SceneRecord> records;
+        std::string texts;
+        Detail::append_records(group, records, texts);
+
+        SceneHeader header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.record_count = records.size();
+        header.text_size = texts.size();
+
+        std::ofstream out{path, std::ios::binary};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SceneRecord)));
+        out.write(texts.data(), static_cast<std::streamsize>(texts.size()));
+        if (!out)
+            throw std::runtime_error("Can not write scene file: " + path);
+    }
+
+    // zero-copy load - texts of loaded Text shapes refer to the mapped file (flyweight mode),
+    // the file stays mapped while any of them is alive
+    inline ShapeGroup load(const std::string& path)
+    {
+        auto file = std::make_shared<const MappedFile>(path);
+
+        SceneHeader header;
+        if (file->size() < sizeof(header))
+            throw std::runtime_error("Corrupted scene file - missing header");
+        std::memcpy(&header, file->data(), sizeof(header));
+
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+            throw std::runtime_error("Not a scene file: " + path);
+        if (header.version != version)
+            throw std::runtime_error("Unsupported version of scene file: " + std::to_string(header.version));
+        if (header.record_count > (file->size() - sizeof(header)) / sizeof(SceneRecord)
+            || header.text_size != file->size() - sizeof(header) - header.record_count * sizeof(SceneRecord))
+            throw std::runtime_error("Corrupted scene file - invalid size");
+
+        const auto* records = reinterpret_cast<const SceneRecord*>(file->data() + sizeof(header));
+        const char* texts = file->data() + sizeof(header) + header.record_count * sizeof(SceneRecord);
+
+        ShapeGroup group;
+        Detail::load_records(file, records, 0, header.record_count, texts, header.text_size, group);
+        return group;
+    }
+}
+
+#endif /*SCENE_FILE_HPP_*/
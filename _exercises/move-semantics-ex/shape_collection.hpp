@@ -0,0 +1,135 @@
+#ifndef SHAPE_COLLECTION_HPP_
+#define SHAPE_COLLECTION_HPP_
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paragraph.hpp"
+
+// Polymorphic collection of shapes segregated by type
+// - every concrete type is stored by value in its own contiguous segment
+// - record() runs a devirtualized loop over each segment (segments in order of TShapes)
+// - insertion order is kept only when requested in constructor - then record() follows it
+template <typename... TShapes>
+class ShapeCollection : public Shape
+{
+    static_assert((std::is_base_of_v<Shape, TShapes> && ...), "ShapeCollection can store only shapes");
+
+    struct Position
+    {
+        uint32_t segment;
+        uint32_t index;
+    };
+
+    std::tuple<std::vector<TShapes>...> segments_;
+    std::vector<Position> order_;
+    bool preserve_order_;
+
+    template <typename TShape>
+    static constexpr uint32_t segment_index()
+    {
+        constexpr std::array matches{std::is_same_v<TShape, TShapes>...};
+        for (uint32_t i = 0; i < matches.size(); ++i)
+            if (matches[i])
+                return i;
+        return matches.size();
+    }
+
+    template <size_t Segment>
+    static void record_one(const ShapeCollection& collection, uint32_t index, RenderCommandBuffer& buffer)
+    {
+        using TShape = std::tuple_element_t<Segment, std::tuple<TShapes...>>;
+        std::get<Segment>(collection.segments_)[index].TShape::record(buffer);
+    }
+
+public:
+    explicit ShapeCollection(bool preserve_order = false)
+        : preserve_order_{preserve_order}
+    {
+    }
+
+    template <typename TShape, typename... TArgs>
+    TShape& emplace(TArgs&&... args)
+    {
+        constexpr uint32_t segment = segment_index<TShape>();
+        static_assert(segment < sizeof...(TShapes), "TShape is not stored in this collection");
+
+        auto& shapes = std::get<segment>(segments_);
+        if (preserve_order_)
+            order_.push_back(Position{segment, static_cast<uint32_t>(shapes.size())});
+
+        return shapes.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    template <typename TShape>
+    TShape& add(TShape shape)
+    {
+        return emplace<TShape>(std::move(shape));
+    }
+
+    template <typename TShape>
+    const std::vector<TShape>& segment() const
+    {
+        return std::get<std::vector<TShape>>(segments_);
+    }
+
+    size_t size() const
+    {
+        return (std::get<std::vector<TShapes>>(segments_).size() + ...);
+    }
+
+    void reserve(size_t size)
+    {
+        (std::get<std::vector<TShapes>>(segments_).reserve(size), ...);
+    }
+
+    void draw() const override
+    {
+        RenderCommandBuffer buffer;
+        record(buffer);
+        buffer.execute(std::cout);
+    }
+
+    void record(RenderCommandBuffer& buffer) const override
+    {
+        if (preserve_order_)
+            record_in_order(buffer, std::index_sequence_for<TShapes...>{});
+        else
+            (record_segment<TShapes>(buffer), ...);
+    }
+
+    Rect bounds() const override
+    {
+        Rect result;
+        auto unite = [&result](const auto& shapes) {
+            for (const auto& shape : shapes)
+                result = result.united(shape.bounds());
+        };
+        (unite(std::get<std::vector<TShapes>>(segments_)), ...);
+        return result;
+    }
+
+private:
+    template <typename TShape>
+    void record_segment(RenderCommandBuffer& buffer) const
+    {
+        for (const auto& shape : std::get<std::vector<TShape>>(segments_))
+            shape.TShape::record(buffer); // qualified call - no virtual dispatch
+    }
+
+    template <size_t... Segments>
+    void record_in_order(RenderCommandBuffer& buffer, std::index_sequence<Segments...>) const
+    {
+        using RecordFunction = void (*)(const ShapeCollection&, uint32_t, RenderCommandBuffer&);
+        static constexpr RecordFunction record_functions[] = {&record_one<Segments>...};
+
+        for (const auto& position : order_)
+            record_functions[position.segment](*this, position.index, buffer);
+    }
+};
+
+#endif /*SHAPE_COLLECTION_HPP_*/
@@ -0,0 +1,201 @@
+#ifndef SPATIAL_INDEX_HPP_
+#define SPATIAL_INDEX_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry.hpp"
+
+// Uniform grid of square cells - every item is registered in all cells covered by its bounds
+// - query cost depends on number of cells covered by the query and items in them, not on total number of items
+// - items are identified by consecutive ids (e.g. index of a shape in a group)
+// - unbounded items (Rect::unbounded()) are not stored in cells - they are candidates of every query
+class UniformGrid
+{
+    int cell_size_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    std::vector<uint32_t> unbounded_;
+    std::vector<Rect> bounds_; // bounds used when item was indexed
+
+    struct CellRange
+    {
+        int first_x, first_y, last_x, last_y;
+
+        // number of cells is at most count - without overflow of width * height (up to 2^64)
+        bool has_at_most(uint64_t count) const
+        {
+            const uint64_t width = static_cast<uint64_t>(int64_t{last_x} - first_x + 1);
+            const uint64_t height = static_cast<uint64_t>(int64_t{last_y} - first_y + 1);
+            return width <= count / height;
+        }
+
+        bool contains(int cx, int cy) const
+        {
+            return first_x <= cx && cx <= last_x && first_y <= cy && cy <= last_y;
+        }
+    };
+
+    CellRange occupied_{}; // covers all cells in cells_ (not shrunk by erase)
+
+public:
+    explicit UniformGrid(int cell_size = 64)
+        : cell_size_{std::max(cell_size, 1)}
+    {
+    }
+
+    int cell_size() const
+    {
+        return cell_size_;
+    }
+
+    size_t size() const
+    {
+        return bounds_.size();
+    }
+
+    void insert(uint32_t id, const Rect& bounds)
+    {
+        if (id >= bounds_.size())
+            bounds_.resize(id + 1);
+        bounds_[id] = bounds;
+
+        if (bounds.is_unbounded())
+        {
+            unbounded_.push_back(id);
+            return;
+        }
+
+        if (bounds.empty())
+            return;
+
+        const CellRange range = cell_range(bounds);
+        if (cells_.empty())
+            occupied_ = range;
+        else
+            occupied_ = CellRange{std::min(occupied_.first_x, range.first_x), std::min(occupied_.first_y, range.first_y),
+                std::max(occupied_.last_x, range.last_x), std::max(occupied_.last_y, range.last_y)};
+
+        for_each_cell(bounds, [this, id](uint64_t key) { cells_[key].push_back(id); });
+    }
+
+    void update(uint32_t id, const Rect& bounds)
+    {
+        if (id < bounds_.size())
+        {
+            if (bounds_[id] == bounds)
+                return;
+            erase(id);
+        }
+        insert(id, bounds);
+    }
+
+    void erase(uint32_t id)
+    {
+        if (bounds_[id].is_unbounded())
+            std::erase(unbounded_, id);
+        else
+            for_each_cell(bounds_[id], [this, id](uint64_t key) {
+                auto cell = cells_.find(key);
+                std::erase(cell->second, id);
+                if (cell->second.empty())
+                    cells_.erase(cell);
+            });
+        bounds_[id] = Rect{};
+    }
+
+    // ids of items intersecting area - sorted
+    // - only cells of the area that lie within the occupied cells are visited;
+    //   when there are more of them than occupied cells, the occupied cells are visited instead
+    std::vector<uint32_t> query(const Rect& area) const
+    {
+        std::vector<uint32_t> result;
+
+        if (area.empty())
+            return result;
+
+        result = unbounded_;
+
+        if (!cells_.empty())
+        {
+            const CellRange area_range = cell_range(area);
+            const CellRange range{std::max(area_range.first_x, occupied_.first_x), std::max(area_range.first_y, occupied_.first_y),
+                std::min(area_range.last_x, occupied_.last_x), std::min(area_range.last_y, occupied_.last_y)};
+
+            if (range.first_x <= range.last_x && range.first_y <= range.last_y)
+            {
+                if (range.has_at_most(cells_.size()))
+                {
+                    // int64_t - last cell may be INT_MAX
+                    for (int64_t cy = range.first_y; cy <= range.last_y; ++cy)
+                        for (int64_t cx = range.first_x; cx <= range.last_x; ++cx)
+                        {
+                            auto cell = cells_.find(key(static_cast<int>(cx), static_cast<int>(cy)));
+                            if (cell != cells_.end())
+                                collect(cell->second, static_cast<int>(cx), static_cast<int>(cy), area, range, result);
+                        }
+                }
+                else
+                {
+                    for (const auto& [cell_key, ids] : cells_)
+                    {
+                        const int cx = static_cast<int>(static_cast<uint32_t>(cell_key >> 32));
+                        const int cy = static_cast<int>(static_cast<uint32_t>(cell_key));
+                        if (range.contains(cx, cy))
+                            collect(ids, cx, cy, area, range, result);
+                    }
+                }
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    static uint64_t key(int cx, int cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    int cell_of(int64_t coordinate) const
+    {
+        return static_cast<int>((coordinate >= 0) ? coordinate / cell_size_ : -((-coordinate - 1) / cell_size_) - 1);
+    }
+
+    CellRange cell_range(const Rect& bounds) const
+    {
+        return CellRange{cell_of(bounds.left), cell_of(bounds.top), cell_of(int64_t{bounds.right} - 1), cell_of(int64_t{bounds.bottom} - 1)};
+    }
+
+    // appends items of the cell (cx, cy) intersecting area
+    // - item covering many cells is reported only from the first cell shared with the range of the area
+    void collect(const std::vector<uint32_t>& ids, int cx, int cy, const Rect& area, const CellRange& range, std::vector<uint32_t>& result) const
+    {
+        for (uint32_t id : ids)
+        {
+            const Rect& bounds = bounds_[id];
+            if (!bounds.intersects(area))
+                continue;
+
+            const CellRange item_range = cell_range(bounds);
+            if (cx == std::max(range.first_x, item_range.first_x) && cy == std::max(range.first_y, item_range.first_y))
+                result.push_back(id);
+        }
+    }
+
+    template <typename F>
+    void for_each_cell(const Rect& bounds, F f) const
+    {
+        if (bounds.empty())
+            return;
+
+        const CellRange range = cell_range(bounds);
+        for (int64_t cy = range.first_y; cy <= range.last_y; ++cy)
+            for (int64_t cx = range.first_x; cx <= range.last_x; ++cx)
+                f(key(static_cast<int>(cx), static_cast<int>(cy)));
+    }
+};
+
+#endif /*SPATIAL_INDEX_HPP_*/
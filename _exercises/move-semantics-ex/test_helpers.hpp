@@ -0,0 +1,50 @@
+#ifndef TEST_HELPERS_HPP_
+#define TEST_HELPERS_HPP_
+
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+namespace TestHelpers
+{
+    class CoutCapture
+    {
+        std::ostringstream output_;
+        std::streambuf* previous_;
+
+    public:
+        CoutCapture()
+            : previous_{std::cout.rdbuf(output_.rdbuf())}
+        {
+        }
+
+        CoutCapture(const CoutCapture&) = delete;
+        CoutCapture& operator=(const CoutCapture&) = delete;
+
+        ~CoutCapture()
+        {
+            std::cout.rdbuf(previous_);
+        }
+
+        std::string str() const
+        {
+            return output_.str();
+        }
+    };
+
+    struct NullBuffer : std::streambuf
+    {
+        int overflow(int c) override
+        {
+            return c;
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize count) override
+        {
+            return count;
+        }
+    };
+}
+
+#endif /*TEST_HELPERS_HPP_*/
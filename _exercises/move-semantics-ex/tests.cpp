@@ -2,6 +2,9 @@
 #include "paragraph.hpp"
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 using namespace std;
@@ -33,4 +36,74 @@ TEST_CASE("ShapeGroup")
 
     Text& t = dynamic_cast<Text&>(*sg.shapes[0]);
     REQUIRE(t.text() == "text"s);
-}
\ No newline at end of file
+}
+TEST_CASE("Paragraph - short text is stored inline")
+{
+    LegacyCode::Paragraph p("***");
+
+    REQUIRE(p.size() == 3);
+    REQUIRE(p.capacity() == LegacyCode::Paragraph::sso_capacity);
+
+    LegacyCode::Paragraph cp = p;
+    REQUIRE(cp.get_paragraph() == "***"s);
+    REQUIRE(cp.get_paragraph() != p.get_paragraph());
+}
+
+TEST_CASE("Paragraph - long text is allocated with exact size")
+{
+    const std::string long_text(5'000, 'x');
+    LegacyCode::Paragraph p(long_text.c_str());
+
+    REQUIRE(p.size() == 5'000);
+    REQUIRE(p.capacity() == 5'000);
+    REQUIRE(p.get_paragraph() == long_text);
+
+    SECTION("set_paragraph reuses buffer")
+    {
+        const char* buffer = p.get_paragraph();
+        p.set_paragraph("short");
+
+        REQUIRE(p.get_paragraph() == "short"s);
+        REQUIRE(p.get_paragraph() == buffer);
+    }
+
+    SECTION("copy & move assignment")
+    {
+        LegacyCode::Paragraph other("abc");
+        other = p;
+        REQUIRE(other.get_paragraph() == long_text);
+
+        LegacyCode::Paragraph target;
+        target = std::move(other);
+        REQUIRE(target.get_paragraph() == long_text);
+        REQUIRE(other.get_paragraph() == nullptr);
+
+        other = target;
+        REQUIRE(other.size() == 5'000);
+    }
+}
+
+TEST_CASE("Text - memory & copy throughput", "[.benchmark]")
+{
+    constexpr size_t no_of_shapes = 1'000'000;
+    constexpr size_t legacy_buffer_size = 1024;
+
+    std::vector<Text> texts;
+    texts.reserve(no_of_shapes);
+    for (size_t i = 0; i < no_of_shapes; ++i)
+        texts.emplace_back(static_cast<int>(i), 0, "label#" + std::to_string(i % 1000));
+
+    size_t heap_bytes = 0;
+    for (const auto& t : texts)
+        heap_bytes += (t.paragraph().capacity() > LegacyCode::Paragraph::sso_capacity) ? t.paragraph().capacity() + 1 : 0;
+
+    std::cout << "Memory for " << no_of_shapes << " Text shapes: "
+              << (no_of_shapes * sizeof(Text) + heap_bytes) / (1024 * 1024) << " MB (legacy buffer: "
+              << (no_of_shapes * (sizeof(Text) + legacy_buffer_size)) / (1024 * 1024) << " MB)\n";
+
+    BENCHMARK("copy 1M Text shapes")
+    {
+        std::vector<Text> copy = texts;
+        return copy.size();
+    };
+}
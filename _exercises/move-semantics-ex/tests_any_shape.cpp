@@ -0,0 +1,220 @@
+#include "any_shape.hpp"
+#include "paragraph.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    struct LegacyShape : Shape
+    {
+        void draw() const override
+        {
+            std::cout << "LegacyShape\n";
+        }
+    };
+
+    std::string captured_draw(const ShapeGroup& group)
+    {
+        CoutCapture capture;
+        group.draw();
+        return capture.str();
+    }
+}
+
+TEST_CASE("any_shape")
+{
+    static_assert(any_shape::is_stored_inline<Text>);
+    static_assert(!any_shape::is_stored_inline<ShapeGroup>);
+
+    any_shape shape = Text{10, 20, "text"};
+
+    REQUIRE(shape.has_value());
+    REQUIRE(shape.target<Text>()->text() == "text"s);
+    REQUIRE(shape.target<ShapeGroup>() == nullptr);
+    REQUIRE(shape.get() == shape.target<Text>());
+    REQUIRE(shape.bounds() == Rect{10, 20, 14, 21});
+
+    SECTION("copy is deep")
+    {
+        any_shape copy = shape;
+        copy.target<Text>()->set_text("copy");
+
+        REQUIRE(shape.target<Text>()->text() == "text"s);
+        REQUIRE(copy.target<Text>()->text() == "copy"s);
+    }
+
+    SECTION("move leaves source empty")
+    {
+        any_shape target = std::move(shape);
+
+        REQUIRE_FALSE(shape.has_value());
+        REQUIRE(shape.get() == nullptr);
+        REQUIRE(target.target<Text>()->text() == "text"s);
+
+        shape = target;
+        REQUIRE(shape.target<Text>()->text() == "text"s);
+    }
+
+    SECTION("draw")
+    {
+        CoutCapture capture;
+        shape.draw();
+
+        REQUIRE(capture.str() == "Rendering text 'text' at: [10, 20]\n");
+    }
+}
+
+TEST_CASE("any_shape - shape owned by unique_ptr")
+{
+    auto text = std::make_unique<Text>(1, 2, "text");
+    Text* address = text.get();
+
+    any_shape shape = std::move(text);
+
+    REQUIRE(shape.get() == address);
+    REQUIRE(shape.target<Text>() == nullptr);
+    REQUIRE(shape.bounds() == Rect{1, 2, 5, 3});
+
+    SECTION("move keeps the address")
+    {
+        any_shape target = std::move(shape);
+        REQUIRE(target.get() == address);
+    }
+
+    SECTION("copy is made with clone()")
+    {
+        any_shape copy = shape;
+
+        REQUIRE(copy.target<Text>() != nullptr);
+        REQUIRE(copy.target<Text>()->text() == "text"s);
+    }
+
+    SECTION("shape without clone() can not be copied")
+    {
+        any_shape legacy = std::make_unique<LegacyShape>();
+        REQUIRE_THROWS_AS(any_shape{legacy}, std::runtime_error);
+    }
+}
+
+TEST_CASE("ShapeGroup - shapes stored by value")
+{
+    ShapeGroup group;
+    group.add(Text{1, 2, "first"});
+    Text& second = group.emplace<Text>(3, 4, "second");
+    second.set_text("second!");
+
+    auto nested = std::make_unique<ShapeGroup>();
+    nested->emplace<Text>(5, 6, "nested");
+    group.add(std::move(nested));
+
+    REQUIRE(group.shapes.size() == 3);
+    REQUIRE(dynamic_cast<Text&>(*group.shapes[1]).text() == "second!"s);
+
+    SECTION("shapes moved in the list stay members of the group")
+    {
+        for (int i = 0; i < 100; ++i)
+            group.emplace<Text>(i, i, "t");
+        for (int i = 0; i < 50; ++i)
+            group.remove(3);
+
+        group.translate(10, 10);
+        static_cast<Text&>(*group.shapes.back()).set_text("last");
+
+        REQUIRE(group.shapes.size() == 53);
+        REQUIRE(group.shapes[0]->bounds() == Rect{11, 12, 16, 13});
+        REQUIRE(group.shapes.back()->bounds() == Rect{109, 109, 113, 110});
+        REQUIRE(captured_draw(group).ends_with("Rendering text 'last' at: [109, 109]\n"));
+    }
+
+    SECTION("copy is deep")
+    {
+        group.redraw();
+        ShapeGroup copy = group;
+
+        static_cast<Text&>(*copy.shapes[0]).move_to(100, 200);
+        static_cast<ShapeGroup&>(*copy.shapes[2]).translate(1, 1);
+
+        REQUIRE(captured_draw(group) == "Rendering text 'first' at: [1, 2]\n"
+                                        "Rendering text 'second!' at: [3, 4]\n"
+                                        "Rendering text 'nested' at: [5, 6]\n");
+
+        CoutCapture capture;
+        copy.redraw();
+        REQUIRE(capture.str() == "Rendering text 'first' at: [100, 200]\n"
+                                 "Rendering text 'second!' at: [3, 4]\n"
+                                 "Rendering text 'nested' at: [6, 7]\n");
+    }
+
+    SECTION("copy assignment")
+    {
+        ShapeGroup copy;
+        copy.emplace<Text>(0, 0, "replaced");
+        copy = group;
+        copy.translate(1, 0);
+
+        REQUIRE(copy.shapes.size() == 3);
+        REQUIRE(captured_draw(copy) == "Rendering text 'first' at: [2, 2]\n"
+                                       "Rendering text 'second!' at: [4, 4]\n"
+                                       "Rendering text 'nested' at: [6, 6]\n");
+    }
+}
+
+TEST_CASE("ShapeGroup - shapes by value vs. unique_ptr", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+
+    BENCHMARK("build - add(make_unique<Text>(...))")
+    {
+        ShapeGroup group;
+        group.reserve(no_of_shapes);
+        for (int i = 0; i < no_of_shapes; ++i)
+            group.add(std::make_unique<Text>(i, i, "txt"));
+        return group.size();
+    };
+
+    BENCHMARK("build - emplace<Text>(...)")
+    {
+        ShapeGroup group;
+        group.reserve(no_of_shapes);
+        for (int i = 0; i < no_of_shapes; ++i)
+            group.emplace<Text>(i, i, "txt");
+        return group.size();
+    };
+
+    ShapeGroup owned;
+    ShapeGroup inline_shapes;
+    for (int i = 0; i < no_of_shapes; ++i)
+    {
+        owned.add(std::make_unique<Text>(i, i, "txt"));
+        inline_shapes.emplace<Text>(i, i, "txt");
+    }
+
+    BENCHMARK("deep copy - shapes added as unique_ptr")
+    {
+        ShapeGroup copy = owned;
+        return copy.size();
+    };
+
+    BENCHMARK("deep copy - shapes stored inline")
+    {
+        ShapeGroup copy = inline_shapes;
+        return copy.size();
+    };
+
+    BENCHMARK("bounds - shapes added as unique_ptr")
+    {
+        return owned.bounds();
+    };
+
+    BENCHMARK("bounds - shapes stored inline")
+    {
+        return inline_shapes.bounds();
+    };
+}
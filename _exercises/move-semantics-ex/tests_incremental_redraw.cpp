@@ -0,0 +1,295 @@
+#include "paragraph.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    struct CountingText : Text
+    {
+        inline static int render_count = 0;
+
+        using Text::Text;
+
+        void render(std::string& output) const override
+        {
+            ++render_count;
+            Text::render(output);
+        }
+    };
+
+    std::string captured_draw(const ShapeGroup& group)
+    {
+        CoutCapture capture;
+        group.draw();
+        return capture.str();
+    }
+
+    std::string captured_redraw(const ShapeGroup& group)
+    {
+        CoutCapture capture;
+        group.redraw();
+        return capture.str();
+    }
+}
+
+TEST_CASE("ShapeGroup::redraw")
+{
+    ShapeGroup scene;
+    std::vector<CountingText*> texts;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto text = std::make_unique<CountingText>(i, i, "text#" + std::to_string(i));
+        texts.push_back(text.get());
+        scene.add(std::move(text));
+    }
+
+    CountingText::render_count = 0;
+
+    SECTION("first redraw renders all shapes")
+    {
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(CountingText::render_count == 10);
+    }
+
+    SECTION("unchanged scene is not rendered again")
+    {
+        scene.redraw();
+        CountingText::render_count = 0;
+
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(CountingText::render_count == 0);
+    }
+
+    SECTION("only changed shapes are rendered again")
+    {
+        scene.redraw();
+        CountingText::render_count = 0;
+
+        texts[3]->set_text("changed");
+        texts[7]->move_to(100, 200);
+        texts[7]->move_to(200, 300);
+
+        const std::string output = captured_redraw(scene);
+
+        REQUIRE(CountingText::render_count == 2);
+        REQUIRE(output == captured_draw(scene));
+        REQUIRE(output.find("Rendering text 'changed' at: [3, 3]") != std::string::npos);
+        REQUIRE(output.find("Rendering text 'text#7' at: [200, 300]") != std::string::npos);
+    }
+
+    SECTION("outputs of equal size are patched in place")
+    {
+        scene.redraw();
+        CountingText::render_count = 0;
+
+        texts[0]->set_text("TEXT#0");
+        texts[9]->set_text("TEXT#9");
+
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(CountingText::render_count == 2);
+    }
+
+    SECTION("subsequent changes of adjacent shapes")
+    {
+        for (int i : {8, 9, 0, 4, 5})
+        {
+            scene.redraw();
+            texts[i]->set_text(std::string(i + 1, 'x'));
+            texts[(i + 1) % 10]->move_to(i * 1000, 0);
+            REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        }
+    }
+
+    SECTION("added shapes are rendered")
+    {
+        scene.redraw();
+        CountingText::render_count = 0;
+
+        scene.add(std::make_unique<CountingText>(50, 50, "new"));
+
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(CountingText::render_count == 1);
+    }
+}
+
+TEST_CASE("ShapeGroup::redraw - changes are propagated through nested groups")
+{
+    auto inner = std::make_unique<ShapeGroup>();
+    auto text = std::make_unique<CountingText>(1, 2, "inner");
+    CountingText* inner_text = text.get();
+    inner->add(std::move(text));
+
+    ShapeGroup scene;
+    scene.add(std::make_unique<CountingText>(0, 0, "outer"));
+    scene.add(std::move(inner));
+
+    scene.redraw();
+    CountingText::render_count = 0;
+
+    inner_text->set_text("changed");
+
+    const std::string output = captured_redraw(scene);
+    REQUIRE(CountingText::render_count == 1);
+    REQUIRE(output == "Rendering text 'outer' at: [0, 0]\nRendering text 'changed' at: [1, 2]\n");
+}
+
+TEST_CASE("ShapeGroup::redraw - moved group keeps tracking changes")
+{
+    auto text = std::make_unique<Text>(1, 2, "text");
+    Text* tracked = text.get();
+
+    ShapeGroup source;
+    source.add(std::move(text));
+    source.redraw();
+
+    ShapeGroup target = std::move(source);
+    tracked->set_text("changed");
+
+    REQUIRE(captured_redraw(target) == "Rendering text 'changed' at: [1, 2]\n");
+}
+
+TEST_CASE("ShapeGroup::redraw - moved shapes update spatial index")
+{
+    ShapeGroup scene;
+    scene.enable_spatial_index(10);
+    auto text = std::make_unique<Text>(5, 5, "text");
+    Text* tracked = text.get();
+    scene.add(std::move(text));
+
+    tracked->move_to(105, 105);
+
+    REQUIRE(scene.query(Rect{0, 0, 50, 50}).empty());
+    REQUIRE(scene.query(Rect{100, 100, 150, 150}) == std::vector<size_t>{0});
+}
+
+TEST_CASE("ShapeGroup::remove - keeps indexes and cache in sync")
+{
+    ShapeGroup scene;
+    std::vector<Text*> texts;
+    for (int i = 0; i < 5; ++i)
+    {
+        auto text = std::make_unique<Text>(10 * i, 0, "text#" + std::to_string(i));
+        texts.push_back(text.get());
+        scene.add(std::move(text));
+    }
+    scene.enable_spatial_index(10);
+    scene.enable_text_index();
+    scene.redraw();
+    texts[3]->set_text("dirty");
+
+    any_shape removed = scene.remove(1);
+
+    REQUIRE(removed.get() == texts[1]);
+    REQUIRE(scene.size() == 4);
+    REQUIRE(captured_redraw(scene) == captured_draw(scene));
+    REQUIRE(scene.query(Rect{0, 0, 100, 1}) == std::vector<size_t>{0, 1, 2, 3});
+    REQUIRE(scene.query(Rect{30, 0, 31, 1}) == std::vector<size_t>{2});
+    REQUIRE(scene.find_all({"text#4"}) == std::vector<size_t>{3});
+    REQUIRE(scene.find_all({"text#1"}).empty());
+
+    SECTION("removed shape is detached")
+    {
+        static_cast<Text&>(*removed).set_text("changed");
+        REQUIRE(captured_redraw(scene).find("changed") == std::string::npos);
+    }
+
+    SECTION("following shapes report changes with their new indexes")
+    {
+        texts[4]->set_text("last");
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(scene.find_any({"last"}) == std::vector<size_t>{3});
+    }
+
+    SECTION("last shape")
+    {
+        scene.remove(3);
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(scene.query(Rect{0, 0, 100, 1}) == std::vector<size_t>{0, 1, 2});
+        REQUIRE(scene.find_all({"text#4"}).empty());
+
+        scene.add(std::make_unique<Text>(40, 0, "added"));
+        REQUIRE(scene.query(Rect{40, 0, 41, 1}) == std::vector<size_t>{3});
+    }
+
+    SECTION("nested group")
+    {
+        auto nested = std::make_unique<ShapeGroup>();
+        nested->add(std::make_unique<Text>(0, 0, "nested"));
+        scene.add(std::move(nested));
+        scene.redraw();
+
+        any_shape group = scene.remove(4);
+        scene.translate(1, 1);
+
+        REQUIRE(captured_redraw(scene) == captured_draw(scene));
+        REQUIRE(captured_draw(static_cast<ShapeGroup&>(*group)) == "Rendering text 'nested' at: [0, 0]\n");
+    }
+}
+
+TEST_CASE("ShapeGroup::shapes - modifications keep indexes and cache in sync")
+{
+    ShapeGroup scene;
+    scene.add(std::make_unique<Text>(1, 2, "first"));
+    scene.add(std::make_unique<Text>(3, 4, "second"));
+    scene.enable_spatial_index(10);
+    scene.enable_text_index();
+    scene.redraw();
+
+    scene.shapes.push_back(std::make_unique<Text>(50, 50, "pushed"));
+
+    REQUIRE(scene.shapes.size() == 3);
+    REQUIRE(captured_redraw(scene) == captured_draw(scene));
+    REQUIRE(scene.find_all({"pushed"}) == std::vector<size_t>{2});
+    REQUIRE(scene.query(Rect{50, 50, 51, 51}) == std::vector<size_t>{2});
+
+    scene.shapes.pop_back();
+    scene.shapes.pop_back();
+
+    REQUIRE(scene.shapes.size() == 1);
+    REQUIRE(captured_redraw(scene) == "Rendering text 'first' at: [1, 2]\n");
+    REQUIRE(scene.find_any({"pushed", "second"}).empty());
+    REQUIRE(scene.query(Rect{0, 0, 100, 100}) == std::vector<size_t>{0});
+
+    scene.shapes.clear();
+
+    REQUIRE(scene.shapes.empty());
+    REQUIRE(captured_redraw(scene).empty());
+}
+
+TEST_CASE("ShapeGroup::redraw - one change in a big scene", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+
+    ShapeGroup scene;
+    std::vector<Text*> texts;
+    for (int i = 0; i < no_of_shapes; ++i)
+    {
+        auto text = std::make_unique<Text>(i, i, "text#" + std::to_string(i));
+        texts.push_back(text.get());
+        scene.add(std::move(text));
+    }
+
+    NullBuffer null_buffer;
+    auto* previous = std::cout.rdbuf(&null_buffer);
+
+    BENCHMARK("ShapeGroup::draw")
+    {
+        texts[no_of_shapes / 2]->set_text("changed");
+        scene.draw();
+    };
+
+    BENCHMARK("ShapeGroup::redraw")
+    {
+        texts[no_of_shapes / 2]->set_text("changed");
+        scene.redraw();
+    };
+
+    std::cout.rdbuf(previous);
+}
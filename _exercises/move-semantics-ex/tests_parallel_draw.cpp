@@ -0,0 +1,79 @@
+#include "paragraph.hpp"
+#include "test_helpers.hpp"
+#include "thread_budget.hpp"
+
+#include <memory>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    std::unique_ptr<ShapeGroup> make_scene(int no_of_shapes, int depth)
+    {
+        auto group = std::make_unique<ShapeGroup>();
+        for (int i = 0; i < no_of_shapes; ++i)
+        {
+            if (depth > 0 && i % 1000 == 500)
+                group->add(make_scene(no_of_shapes / 2, depth - 1));
+            else
+                group->add(std::make_unique<Text>(i, depth, "text#" + std::to_string(i)));
+        }
+        return group;
+    }
+}
+
+TEST_CASE("ThreadBudget")
+{
+    ThreadBudget budget{4};
+
+    REQUIRE(budget.available() == 3);
+    REQUIRE(budget.try_acquire(2) == 2);
+    REQUIRE(budget.try_acquire(2) == 1);
+    REQUIRE(budget.try_acquire(2) == 0);
+
+    budget.release(3);
+    REQUIRE(budget.available() == 3);
+}
+
+TEST_CASE("ShapeGroup::draw_parallel - output is identical to draw()")
+{
+    auto scene = make_scene(20'000, 2);
+
+    std::string sequential;
+    {
+        CoutCapture capture;
+        scene->draw();
+        sequential = capture.str();
+    }
+
+    for (unsigned no_of_threads : {1u, 2u, 4u, 16u})
+    {
+        CoutCapture capture;
+        scene->draw_parallel(no_of_threads);
+        REQUIRE(capture.str() == sequential);
+    }
+}
+
+TEST_CASE("ShapeGroup::draw_parallel - speedup", "[.benchmark]")
+{
+    auto scene = make_scene(1'000'000, 1);
+
+    NullBuffer null_buffer;
+    auto* previous = std::cout.rdbuf(&null_buffer);
+
+    BENCHMARK("ShapeGroup::draw")
+    {
+        scene->draw();
+    };
+
+    BENCHMARK("ShapeGroup::draw_parallel")
+    {
+        scene->draw_parallel();
+    };
+
+    std::cout.rdbuf(previous);
+}
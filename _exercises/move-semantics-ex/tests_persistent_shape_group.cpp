@@ -0,0 +1,148 @@
+#include "persistent_shape_group.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    PersistentShapeGroup make_scene(int no_of_shapes)
+    {
+        PersistentShapeGroup scene;
+        for (int i = 0; i < no_of_shapes; ++i)
+            scene.emplace<Text>(i, i, "text#" + std::to_string(i));
+        return scene;
+    }
+
+    const Text& text_at(const PersistentShapeGroup& scene, size_t index)
+    {
+        return static_cast<const Text&>(scene[index]);
+    }
+
+    size_t count_nodes(const UndoHistory<PersistentShapeGroup>& history)
+    {
+        std::set<const void*> nodes;
+        history.for_each_version([&nodes](const PersistentShapeGroup& version) {
+            version.visit_nodes([&nodes](const void* node) { nodes.insert(node); });
+        });
+        return nodes.size();
+    }
+}
+
+TEST_CASE("PersistentShapeGroup")
+{
+    constexpr int no_of_shapes = 5'000; // three levels of the tree
+
+    PersistentShapeGroup scene = make_scene(no_of_shapes);
+
+    REQUIRE(scene.size() == no_of_shapes);
+    for (int i = 0; i < no_of_shapes; ++i)
+        REQUIRE(text_at(scene, i).text() == "text#" + std::to_string(i));
+
+    SECTION("snapshot is not changed by edits")
+    {
+        const PersistentShapeGroup snapshot = scene;
+
+        scene.modify<Text>(1234, [](Text& text) { text.set_text("changed"); });
+        scene.emplace<Text>(0, 0, "added");
+
+        REQUIRE(text_at(scene, 1234).text() == "changed");
+        REQUIRE(scene.size() == no_of_shapes + 1);
+
+        REQUIRE(text_at(snapshot, 1234).text() == "text#1234");
+        REQUIRE(snapshot.size() == no_of_shapes);
+    }
+
+    SECTION("unchanged shapes are shared")
+    {
+        const PersistentShapeGroup snapshot = scene;
+        scene.modify<Text>(10, [](Text& text) { text.move_to(-1, -1); });
+
+        REQUIRE(&scene[10] != &snapshot[10]);
+        REQUIRE(&scene[11] == &snapshot[11]);
+        REQUIRE(&scene[4'999] == &snapshot[4'999]);
+    }
+
+    SECTION("draw")
+    {
+        PersistentShapeGroup small = make_scene(2);
+
+        CoutCapture capture;
+        small.draw();
+        REQUIRE(capture.str() == "Rendering text 'text#0' at: [0, 0]\nRendering text 'text#1' at: [1, 1]\n");
+    }
+}
+
+TEST_CASE("UndoHistory of PersistentShapeGroup")
+{
+    UndoHistory<PersistentShapeGroup> history{make_scene(10'000)};
+    const size_t initial_nodes = count_nodes(history);
+
+    for (int i = 0; i < 1'000; ++i)
+    {
+        PersistentShapeGroup next = history.current();
+        next.modify<Text>(i * 7, [i](Text& text) { text.set_text("edit#" + std::to_string(i)); });
+        history.commit(std::move(next));
+    }
+
+    SECTION("memory is proportional to edits")
+    {
+        // 10'000 shapes - three levels, an edit copies at most three nodes
+        REQUIRE(count_nodes(history) <= initial_nodes + 3 * 1'000);
+    }
+
+    SECTION("undo & redo")
+    {
+        REQUIRE(text_at(history.current(), 999 * 7).text() == "edit#999");
+
+        REQUIRE(history.undo());
+        REQUIRE(text_at(history.current(), 999 * 7).text() == "text#6993");
+        REQUIRE(text_at(history.current(), 998 * 7).text() == "edit#998");
+
+        REQUIRE(history.redo());
+        REQUIRE(text_at(history.current(), 999 * 7).text() == "edit#999");
+        REQUIRE_FALSE(history.redo());
+
+        while (history.undo())
+            ;
+        REQUIRE(history.redo_depth() == 1'000);
+        REQUIRE(text_at(history.current(), 0).text() == "text#0");
+
+        PersistentShapeGroup next = history.current();
+        next.emplace<Text>(0, 0, "new branch");
+        history.commit(std::move(next));
+        REQUIRE(history.redo_depth() == 0);
+    }
+}
+
+TEST_CASE("PersistentShapeGroup - snapshot & edit of 1M shapes", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+
+    ShapeGroup group;
+    for (int i = 0; i < no_of_shapes; ++i)
+        group.add(std::make_unique<Text>(i, i, "text#" + std::to_string(i)));
+
+    BENCHMARK("ShapeGroup - deep copy & edit")
+    {
+        ShapeGroup snapshot = group;
+        static_cast<Text&>(*snapshot.shapes[500]).set_text("changed");
+        return snapshot.shapes.size();
+    };
+
+    UndoHistory<PersistentShapeGroup> history{make_scene(no_of_shapes)};
+
+    BENCHMARK("PersistentShapeGroup - snapshot & edit")
+    {
+        PersistentShapeGroup next = history.current();
+        next.modify<Text>(500, [](Text& text) { text.set_text("changed"); });
+        history.commit(std::move(next));
+        return history.undo_depth();
+    };
+}
@@ -0,0 +1,286 @@
+#include "paragraph.hpp"
+#include "position_table.hpp"
+#include "test_helpers.hpp"
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    std::vector<int> random_values(size_t count)
+    {
+        std::mt19937 rnd{42};
+        std::uniform_int_distribution<int> distribution{-100'000, 100'000};
+
+        std::vector<int> values(count);
+        for (auto& v : values)
+            v = distribution(rnd);
+        return values;
+    }
+
+    std::string captured_draw(const ShapeGroup& group)
+    {
+        CoutCapture capture;
+        group.draw();
+        return capture.str();
+    }
+}
+
+TEST_CASE("PositionKernels - same results as scalar code")
+{
+    for (size_t count : {0u, 1u, 3u, 4u, 7u, 1001u})
+    {
+        const std::vector<int> values = random_values(count);
+
+        SECTION("translate")
+        {
+            std::vector<int> result = values;
+            PositionKernels::translate(result.data(), result.size(), -17);
+
+            for (size_t i = 0; i < count; ++i)
+                REQUIRE(result[i] == values[i] - 17);
+        }
+
+        SECTION("scale")
+        {
+            std::vector<int> result = values;
+            PositionKernels::scale(result.data(), result.size(), 1.5f, 10);
+
+            for (size_t i = 0; i < count; ++i)
+                REQUIRE(result[i] == 10 + static_cast<int>(std::nearbyint(static_cast<float>(values[i] - 10) * 1.5f)));
+        }
+
+        SECTION("clamp")
+        {
+            std::vector<int> result = values;
+            PositionKernels::clamp(result.data(), result.size(), -500, 1000);
+
+            for (size_t i = 0; i < count; ++i)
+                REQUIRE(result[i] == std::clamp(values[i], -500, 1000));
+        }
+    }
+}
+
+TEST_CASE("PositionKernels - overflow near limits of int")
+{
+    constexpr int max = std::numeric_limits<int>::max();
+    constexpr int min = std::numeric_limits<int>::min();
+    // first 4 values are transformed by SSE2 kernels, the same 3 values in the tail by scalar code
+    const std::vector<int> values = {max, min, max - 2, -5, max, min, max - 2};
+
+    auto require_same_as_tail = [](const std::vector<int>& result) {
+        for (size_t i = 0; i < 3; ++i)
+            REQUIRE(result[i] == result[i + 4]);
+    };
+
+    SECTION("translate wraps around")
+    {
+        std::vector<int> result = values;
+        PositionKernels::translate(result.data(), result.size(), 3);
+
+        require_same_as_tail(result);
+        REQUIRE(result[0] == min + 2);
+        REQUIRE(result[2] == min);
+    }
+
+    SECTION("scale out of range of int")
+    {
+        std::vector<int> result = values;
+        PositionKernels::scale(result.data(), result.size(), 2.0f, -10);
+
+        require_same_as_tail(result);
+        REQUIRE(result[3] == 0);
+    }
+}
+
+TEST_CASE("ShapeGroup - transforms of positions")
+{
+    auto inner = std::make_unique<ShapeGroup>();
+    auto nested_text = std::make_unique<Text>(10, 20, "nested");
+    Text* nested = nested_text.get();
+    inner->add(std::move(nested_text));
+
+    ShapeGroup scene;
+    auto text = std::make_unique<Text>(1, 2, "text");
+    Text* top = text.get();
+    scene.add(std::move(text));
+    scene.add(std::move(inner));
+
+    SECTION("translate")
+    {
+        scene.translate(5, -5);
+
+        REQUIRE(top->x() == 6);
+        REQUIRE(top->y() == -3);
+        REQUIRE(nested->x() == 15);
+        REQUIRE(nested->y() == 15);
+    }
+
+    SECTION("scale")
+    {
+        scene.scale(2.0f, 1, 0);
+
+        REQUIRE(top->x() == 1);
+        REQUIRE(top->y() == 4);
+        REQUIRE(nested->x() == 19);
+        REQUIRE(nested->y() == 40);
+    }
+
+    SECTION("clamp")
+    {
+        scene.clamp(Rect{0, 0, 5, 5});
+
+        REQUIRE(top->x() == 1);
+        REQUIRE(top->y() == 2);
+        REQUIRE(nested->x() == 4);
+        REQUIRE(nested->y() == 4);
+    }
+
+    SECTION("move_to of Text in group")
+    {
+        top->move_to(100, 200);
+        scene.translate(1, 1);
+
+        REQUIRE(top->x() == 101);
+        REQUIRE(top->y() == 201);
+    }
+
+    SECTION("copy is not bound to the group")
+    {
+        Text copy = *top;
+        scene.translate(1, 1);
+
+        REQUIRE(copy.x() == 1);
+        REQUIRE(copy.y() == 2);
+        REQUIRE(top->x() == 2);
+    }
+
+    SECTION("redraw after transform")
+    {
+        scene.redraw();
+        scene.translate(1000, 1000);
+
+        CoutCapture capture;
+        scene.redraw();
+        REQUIRE(capture.str() == "Rendering text 'text' at: [1001, 1002]\nRendering text 'nested' at: [1010, 1020]\n");
+        REQUIRE(capture.str() == captured_draw(scene));
+    }
+}
+
+TEST_CASE("ShapeGroup - Text moved between groups")
+{
+    auto source = std::make_unique<ShapeGroup>();
+    auto text = std::make_unique<Text>(1, 2, "text");
+    Text* moved = text.get();
+    source->add(std::move(text));
+    source->add(std::make_unique<Text>(3, 4, "other"));
+    source->translate(10, 10);
+
+    ShapeGroup target;
+    target.add(source->remove(0));
+
+    REQUIRE(moved->x() == 11);
+    REQUIRE(moved->y() == 12);
+
+    source->translate(100, 100);
+    REQUIRE(moved->x() == 11);
+
+    target.translate(1, 1);
+    REQUIRE(moved->x() == 12);
+    REQUIRE(moved->y() == 13);
+
+    source.reset();
+    moved->move_to(5, 5);
+    REQUIRE(captured_draw(target) == "Rendering text 'text' at: [5, 5]\n");
+
+    SECTION("slot of a destroyed text is reused")
+    {
+        target.add(std::make_unique<Text>(7, 8, "second"));
+        target.remove(0).reset();
+        target.add(std::make_unique<Text>(9, 10, "third"));
+        target.translate(1, 1);
+
+        REQUIRE(captured_draw(target) == "Rendering text 'second' at: [8, 9]\nRendering text 'third' at: [10, 11]\n");
+    }
+}
+
+TEST_CASE("ShapeGroup - transforms update spatial index")
+{
+    ShapeGroup scene;
+    scene.enable_spatial_index(10);
+    scene.add(std::make_unique<Text>(5, 5, "text"));
+
+    scene.translate(100, 100);
+
+    REQUIRE(scene.query(Rect{0, 0, 50, 50}).empty());
+    REQUIRE(scene.query(Rect{100, 100, 150, 150}) == std::vector<size_t>{0});
+}
+
+TEST_CASE("PositionTable - transforms of 10M positions", "[.benchmark]")
+{
+    constexpr size_t no_of_positions = 10'000'000;
+
+    PositionTable table;
+    table.reserve(no_of_positions);
+    for (size_t i = 0; i < no_of_positions; ++i)
+        table.insert(static_cast<int>(i % 10'000), static_cast<int>(i / 10'000));
+
+    BENCHMARK("PositionTable::translate")
+    {
+        table.translate(1, -1);
+        return table.x(0);
+    };
+
+    BENCHMARK("PositionTable::scale")
+    {
+        table.scale(1.0f, 5, 5);
+        return table.x(0);
+    };
+
+    BENCHMARK("PositionTable::clamp")
+    {
+        table.clamp(Rect{0, 0, 5'000, 5'000});
+        return table.x(0);
+    };
+
+    std::vector<int> xs(no_of_positions), ys(no_of_positions);
+
+    BENCHMARK("std::copy of positions (memory bandwidth)")
+    {
+        std::copy(xs.begin(), xs.end(), ys.begin());
+        return ys[0];
+    };
+}
+
+TEST_CASE("ShapeGroup - translate vs. move_to of every Text", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+
+    ShapeGroup scene;
+    std::vector<Text*> texts;
+    for (int i = 0; i < no_of_shapes; ++i)
+    {
+        auto text = std::make_unique<Text>(i, i, "text");
+        texts.push_back(text.get());
+        scene.add(std::move(text));
+    }
+
+    BENCHMARK("Text::move_to of every shape")
+    {
+        for (Text* text : texts)
+            text->move_to(text->x() + 1, text->y() + 1);
+    };
+
+    BENCHMARK("ShapeGroup::translate")
+    {
+        scene.translate(1, 1);
+    };
+}
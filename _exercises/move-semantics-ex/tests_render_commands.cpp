@@ -0,0 +1,172 @@
+#include "paragraph.hpp"
+#include "render_commands.hpp"
+#include "test_helpers.hpp"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+TEST_CASE("RenderCommandBuffer")
+{
+    RenderCommandBuffer buffer;
+    buffer.record_text(10, 20, "abc");
+    buffer.record_text(1, 2, "def");
+
+    REQUIRE(buffer.size() == 2);
+    REQUIRE(buffer.text(buffer.commands()[1]) == "def");
+
+    SECTION("execute renders all commands")
+    {
+        std::ostringstream out;
+        buffer.execute(out);
+        buffer.execute(out); // replay
+
+        REQUIRE(out.str() == "Rendering text 'abc' at: [10, 20]\n"
+                             "Rendering text 'def' at: [1, 2]\n"
+                             "Rendering text 'abc' at: [10, 20]\n"
+                             "Rendering text 'def' at: [1, 2]\n");
+    }
+
+    SECTION("sort by position")
+    {
+        buffer.sort_by_position();
+
+        REQUIRE(buffer.text(buffer.commands()[0]) == "def");
+    }
+
+    SECTION("merge")
+    {
+        RenderCommandBuffer other;
+        other.record_text(-5, 0, "ghi");
+        buffer.append(other);
+
+        std::string output;
+        buffer.render(output);
+
+        REQUIRE(buffer.size() == 3);
+        REQUIRE(output.ends_with("Rendering text 'ghi' at: [-5, 0]\n"));
+    }
+}
+
+TEST_CASE("ShapeGroup::draw - renders the same output as drawing shapes one by one")
+{
+    ShapeGroup group;
+    group.add(std::make_unique<Text>(10, 20, "text"));
+
+    auto nested = std::make_unique<ShapeGroup>();
+    nested->add(std::make_unique<Text>(1, 2, "nested"));
+    group.add(std::move(nested));
+    group.add(std::make_unique<Text>(-1, 0, "last"));
+
+    CoutCapture capture;
+    group.draw();
+
+    REQUIRE(capture.str() == "Rendering text 'text' at: [10, 20]\n"
+                             "Rendering text 'nested' at: [1, 2]\n"
+                             "Rendering text 'last' at: [-1, 0]\n");
+}
+
+namespace
+{
+    // shape implementing only draw() - as shapes written before record() and bounds() existed
+    struct LegacyShape : Shape
+    {
+        void draw() const override
+        {
+            std::cout << "Legacy shape\n";
+        }
+    };
+
+    // shape without record() that can be drawn to any stream
+    struct StreamShape : Shape
+    {
+        void draw() const override
+        {
+            draw_to(std::cout);
+        }
+
+        void draw_to(std::ostream& out) const override
+        {
+            out << "Stream shape\n";
+        }
+    };
+}
+
+TEST_CASE("ShapeGroup::draw - shapes without record() are drawn with draw_to()")
+{
+    ShapeGroup group;
+    group.add(std::make_unique<Text>(1, 2, "first"));
+    group.add(std::make_unique<StreamShape>());
+    group.add(std::make_unique<Text>(3, 4, "last"));
+
+    const std::string expected = "Rendering text 'first' at: [1, 2]\n"
+                                 "Stream shape\n"
+                                 "Rendering text 'last' at: [3, 4]\n";
+
+    SECTION("draw")
+    {
+        CoutCapture capture;
+        group.draw();
+        REQUIRE(capture.str() == expected);
+    }
+
+    SECTION("rendered")
+    {
+        REQUIRE(group.rendered() == expected);
+    }
+
+    SECTION("merged buffers")
+    {
+        RenderCommandBuffer buffer;
+        buffer.record_text(0, 0, "head");
+        RenderCommandBuffer recorded;
+        group.record(recorded);
+        buffer.append(recorded);
+
+        std::ostringstream out;
+        buffer.execute(out);
+        REQUIRE(out.str() == "Rendering text 'head' at: [0, 0]\n" + expected);
+    }
+
+    SECTION("shapes implementing only draw()")
+    {
+        ShapeGroup legacy;
+        legacy.add(std::make_unique<Text>(1, 2, "first"));
+        legacy.add(std::make_unique<LegacyShape>());
+
+        CoutCapture capture;
+        legacy.draw();
+        REQUIRE(capture.str() == "Rendering text 'first' at: [1, 2]\nLegacy shape\n");
+
+        // std::cout is not redirected to render them into a string
+        REQUIRE_THROWS_AS(legacy.rendered(), std::runtime_error);
+    }
+}
+
+TEST_CASE("ShapeGroup::draw - recorded vs. immediate rendering", "[.benchmark]")
+{
+    ShapeGroup group;
+    for (int i = 0; i < 100'000; ++i)
+        group.add(std::make_unique<Text>(i, i, "text#" + std::to_string(i)));
+
+    NullBuffer null_buffer;
+    auto* previous = std::cout.rdbuf(&null_buffer);
+
+    BENCHMARK("draw shape by shape")
+    {
+        for (const auto& s : group.shapes)
+            s->draw();
+    };
+
+    BENCHMARK("ShapeGroup::draw - recorded")
+    {
+        group.draw();
+    };
+
+    std::cout.rdbuf(previous);
+}
@@ -0,0 +1,218 @@
+#include "paragraph.hpp"
+#include "rope.hpp"
+#include "test_helpers.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    std::string make_text(size_t size)
+    {
+        std::string text(size, ' ');
+        for (size_t i = 0; i < size; ++i)
+            text[i] = static_cast<char>('a' + i % 26);
+        return text;
+    }
+}
+
+TEST_CASE("Rope - random edits give the same text as std::string")
+{
+    std::mt19937 rnd{42};
+    std::string expected = make_text(10'000);
+    Rope rope{expected};
+
+    for (int i = 0; i < 5'000; ++i)
+    {
+        const size_t pos = std::uniform_int_distribution<size_t>{0, expected.size()}(rnd);
+
+        if (rnd() % 3 != 0)
+        {
+            const std::string text = make_text(rnd() % 3 == 0 ? 2'000 : 3);
+            rope.insert(pos, text);
+            expected.insert(pos, text);
+        }
+        else
+        {
+            const size_t count = rnd() % 500;
+            rope.erase(pos, count);
+            expected.erase(pos, count);
+        }
+
+        REQUIRE(rope.size() == expected.size());
+        if (i % 100 == 0)
+        {
+            REQUIRE(rope.c_str() == expected);
+            REQUIRE(rope.substr(pos, 777) == expected.substr(pos, 777));
+        }
+    }
+
+    REQUIRE(rope.c_str() == expected);
+
+    // AVL tree of chunks - height is at most ~1.44 log2(number of chunks)
+    REQUIRE(rope.height() <= 2 + 1.45 * std::log2(2.0 * expected.size()));
+}
+
+TEST_CASE("Paragraph - rope storage")
+{
+    const std::string text = make_text(100'000);
+    LegacyCode::Paragraph p{text.c_str()};
+    p.use_rope();
+
+    REQUIRE(p.is_rope());
+    REQUIRE(p.size() == text.size());
+    REQUIRE(p.get_paragraph() == text);
+    REQUIRE(p.capacity() == 0);
+
+    SECTION("insert & erase")
+    {
+        p.insert(50'000, "<inserted>");
+        p.erase(0, 10);
+
+        std::string expected = text;
+        expected.insert(50'000, "<inserted>");
+        expected.erase(0, 10);
+
+        REQUIRE(p.size() == expected.size());
+        REQUIRE(p.get_paragraph() == expected);
+        REQUIRE(p.substr(49'990, 10) == "<inserted>");
+    }
+
+    SECTION("get_paragraph() is cached until the next edit")
+    {
+        const char* flat = p.get_paragraph();
+        REQUIRE(p.get_paragraph() == flat);
+    }
+
+    SECTION("copy is independent")
+    {
+        LegacyCode::Paragraph copy = p;
+        copy.insert(0, "copy");
+
+        REQUIRE(copy.is_rope());
+        REQUIRE(copy.size() == text.size() + 4);
+        REQUIRE(p.get_paragraph() == text);
+    }
+
+    SECTION("move")
+    {
+        LegacyCode::Paragraph target = std::move(p);
+
+        REQUIRE(target.is_rope());
+        REQUIRE(target.get_paragraph() == text);
+        REQUIRE(p.get_paragraph() == nullptr);
+        REQUIRE_FALSE(p.is_rope());
+    }
+
+    SECTION("set_paragraph keeps rope storage")
+    {
+        p.set_paragraph("short");
+
+        REQUIRE(p.is_rope());
+        REQUIRE(p.get_paragraph() == std::string("short"));
+    }
+
+    SECTION("render_at streams chunks")
+    {
+        LegacyCode::Paragraph flat{text.c_str()};
+
+        CoutCapture rope_output;
+        p.render_at(1, 2);
+        const std::string rendered = rope_output.str();
+
+        CoutCapture flat_output;
+        flat.render_at(1, 2);
+        REQUIRE(rendered == flat_output.str());
+    }
+}
+
+TEST_CASE("Paragraph - const access to rope does not flatten it")
+{
+    std::string text = make_text(10'000);
+    text.replace(Rope::max_chunk_size - 1, 2, "\xC5\xBC"); // 'ż' split between the first two chunks
+    text.replace(3 * Rope::max_chunk_size - 3, 6, "needle");
+
+    LegacyCode::Paragraph p{text.c_str()};
+    p.use_rope();
+    p.insert(5'000, "x");
+    text.insert(5'000, "x");
+
+    const LegacyCode::Paragraph& cp = p;
+
+    REQUIRE(cp.get_paragraph() == nullptr);
+    REQUIRE(cp.str() == text);
+    REQUIRE(cp.find('x') == text.find('x'));
+    REQUIRE(cp.find("needle") == 3 * Rope::max_chunk_size - 3);
+    REQUIRE(cp.find("needle", 3 * Rope::max_chunk_size) == LegacyCode::Paragraph::npos);
+    REQUIRE(cp.find("") == 0);
+    REQUIRE(cp.is_valid_utf8());
+
+    RenderCommandBuffer buffer;
+    buffer.record_text(1, 2, {});
+    cp.for_each_chunk([&buffer](std::string_view chunk) { buffer.append_text(chunk); });
+    REQUIRE(buffer.text(buffer.commands().front()) == text);
+
+    REQUIRE(cp.get_paragraph() == nullptr);
+    REQUIRE(p.get_paragraph() == text);
+    REQUIRE(cp.get_paragraph() == text);
+
+    SECTION("incomplete UTF-8 sequences")
+    {
+        p.insert(p.size(), "\xC5");
+        REQUIRE_FALSE(cp.is_valid_utf8());
+
+        p.insert(p.size(), "\xBC");
+        REQUIRE(cp.is_valid_utf8());
+
+        p.erase(Rope::max_chunk_size, 1);
+        REQUIRE_FALSE(cp.is_valid_utf8());
+    }
+}
+
+TEST_CASE("Paragraph - edits without rope")
+{
+    LegacyCode::Paragraph p{"abcdef"};
+    p.insert(3, "XYZXYZXYZXYZXYZ");
+    p.erase(0, 1);
+
+    REQUIRE(p.get_paragraph() == std::string("bcXYZXYZXYZXYZXYZdef"));
+    REQUIRE(p.substr(2, 3) == "XYZ");
+}
+
+TEST_CASE("Paragraph - keystrokes in 4MB paragraph", "[.benchmark]")
+{
+    const std::string text = make_text(4'000'000);
+
+    LegacyCode::Paragraph plain{text.c_str()};
+    LegacyCode::Paragraph rope{text.c_str()};
+    rope.use_rope();
+
+    std::mt19937 rnd{42};
+
+    BENCHMARK("insert & erase - contiguous buffer")
+    {
+        const size_t pos = rnd() % text.size();
+        plain.insert(pos, "x");
+        plain.erase(pos, 1);
+        return plain.size();
+    };
+
+    BENCHMARK("insert & erase - rope")
+    {
+        const size_t pos = rnd() % text.size();
+        rope.insert(pos, "x");
+        rope.erase(pos, 1);
+        return rope.size();
+    };
+
+    BENCHMARK("substr - rope")
+    {
+        return rope.substr(rnd() % (text.size() - 100), 100);
+    };
+}
@@ -0,0 +1,194 @@
+#include "scene_file.hpp"
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    std::string temp_path(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    std::string captured_draw(const ShapeGroup& group)
+    {
+        CoutCapture capture;
+        group.draw();
+        return capture.str();
+    }
+
+    ShapeGroup make_scene(int no_of_shapes)
+    {
+        ShapeGroup scene;
+        scene.reserve(no_of_shapes);
+        for (int i = 0; i < no_of_shapes; ++i)
+            scene.add(std::make_unique<Text>(i, -i, "text#" + std::to_string(i)));
+        return scene;
+    }
+}
+
+TEST_CASE("SceneFile - save & load")
+{
+    const std::string path = temp_path("tests_scene_file.scene");
+
+    ShapeGroup scene;
+    scene.add(std::make_unique<Text>(1, 2, "first"));
+    auto nested = std::make_unique<ShapeGroup>();
+    nested->add(std::make_unique<Text>(3, 4, "nested"));
+    nested->add(std::make_unique<ShapeGroup>());
+    nested->add(std::make_unique<Text>(5, 6, ""));
+    scene.add(std::move(nested));
+    scene.add(std::make_unique<Text>(7, 8, "last"));
+
+    SceneFile::save(scene, path);
+
+    SECTION("loaded scene draws the same output")
+    {
+        ShapeGroup loaded = SceneFile::load(path);
+
+        REQUIRE(loaded.shapes.size() == 3);
+        REQUIRE(captured_draw(loaded) == captured_draw(scene));
+    }
+
+    SECTION("texts refer to the mapped file")
+    {
+        any_shape kept;
+        {
+            ShapeGroup loaded = SceneFile::load(path);
+            REQUIRE(static_cast<const Text*>(loaded.shapes.front())->is_flyweight());
+            kept = loaded.remove(0);
+        }
+
+        // mapping is kept alive by the text
+        REQUIRE(kept.target<Text>()->text() == "first");
+    }
+
+    SECTION("loaded texts can be edited")
+    {
+        ShapeGroup loaded = SceneFile::load(path);
+        auto& text = static_cast<Text&>(*loaded.shapes.back());
+        text.set_text("edited");
+        text.move_to(10, 20);
+
+        REQUIRE(text.text() == "edited");
+        REQUIRE(captured_draw(loaded).ends_with("Rendering text 'edited' at: [10, 20]\n"));
+
+        auto& first = static_cast<Text&>(*loaded.shapes.front());
+        LegacyCode::Paragraph p = first.paragraph();
+        p.insert(5, "!");
+        p.erase(0, 1);
+        REQUIRE(std::string_view{p.get_paragraph()} == "irst!");
+
+        first.set_text("");
+        REQUIRE(first.text() == "");
+    }
+
+    SECTION("assigning empty text to loaded text does not write to the mapped file")
+    {
+        ShapeGroup loaded = SceneFile::load(path);
+        auto& text = static_cast<Text&>(*loaded.shapes.front());
+
+        LegacyCode::Paragraph p = text.paragraph();
+        p.set_paragraph("");
+        REQUIRE(p.size() == 0);
+
+        LegacyCode::Paragraph erased = text.paragraph();
+        erased.erase(0, erased.size());
+        REQUIRE(erased.size() == 0);
+
+        REQUIRE(text.text() == "first");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("SceneFile - invalid files")
+{
+    const std::string path = temp_path("tests_scene_file_invalid.scene");
+
+    SECTION("not a scene file")
+    {
+        std::ofstream{path} << "some text that is not a scene";
+        REQUIRE_THROWS_AS(SceneFile::load(path), std::runtime_error);
+    }
+
+    SECTION("truncated file")
+    {
+        SceneFile::save(make_scene(10), path);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        REQUIRE_THROWS_AS(SceneFile::load(path), std::runtime_error);
+    }
+
+    SECTION("groups nested too deep")
+    {
+        // crafted file - every group record contains all following records
+        constexpr size_t depth = 1'000'000;
+        std::vector<SceneFile::SceneRecord> records(depth);
+        for (size_t i = 0; i < depth; ++i)
+            records[i] = SceneFile::SceneRecord{SceneFile::RecordType::group, 0, 0, static_cast<uint32_t>(depth - i - 1), 0};
+
+        SceneFile::SceneHeader header{};
+        std::memcpy(header.magic, SceneFile::magic, sizeof(SceneFile::magic));
+        header.version = SceneFile::version;
+        header.record_count = depth;
+
+        std::ofstream out{path, std::ios::binary};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(depth * sizeof(SceneFile::SceneRecord)));
+        out.close();
+
+        REQUIRE_THROWS_AS(SceneFile::load(path), std::runtime_error);
+    }
+
+    SECTION("groups nested too deep can not be saved")
+    {
+        ShapeGroup scene;
+        ShapeGroup* group = &scene;
+        for (size_t i = 0; i < SceneFile::max_depth; ++i)
+        {
+            auto nested = std::make_unique<ShapeGroup>();
+            ShapeGroup* next = nested.get();
+            group->add(std::move(nested));
+            group = next;
+        }
+
+        REQUIRE_THROWS_AS(SceneFile::save(scene, path), std::invalid_argument);
+    }
+
+    SECTION("missing file")
+    {
+        REQUIRE_THROWS_AS(SceneFile::load(temp_path("tests_scene_file_missing.scene")), std::runtime_error);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("SceneFile - load of 1M shapes vs. rebuild", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+    const std::string path = temp_path("tests_scene_file_benchmark.scene");
+    SceneFile::save(make_scene(no_of_shapes), path);
+
+    BENCHMARK("rebuild with add(make_unique<Text>(...))")
+    {
+        return make_scene(no_of_shapes);
+    };
+
+    BENCHMARK("SceneFile::load - shapes constructed in place")
+    {
+        return SceneFile::load(path);
+    };
+
+    std::remove(path.c_str());
+}
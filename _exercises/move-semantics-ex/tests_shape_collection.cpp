@@ -0,0 +1,120 @@
+#include "paragraph.hpp"
+#include "shape_collection.hpp"
+#include "test_helpers.hpp"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+namespace
+{
+    struct Dot : Shape
+    {
+        int x, y;
+
+        Dot(int x, int y)
+            : x{x}
+            , y{y}
+        {
+        }
+
+        void draw() const override
+        {
+            std::cout << "Dot at: [" << x << ", " << y << "]\n";
+        }
+
+        Rect bounds() const override
+        {
+            return Rect::point(x, y);
+        }
+    };
+}
+
+TEST_CASE("ShapeCollection")
+{
+    ShapeCollection<Text, Dot> shapes;
+    shapes.add(Text{1, 2, "one"});
+    shapes.emplace<Dot>(3, 4);
+    shapes.add(Text{5, 6, "two"});
+
+    REQUIRE(shapes.size() == 3);
+    REQUIRE(shapes.segment<Text>().size() == 2);
+    REQUIRE(shapes.segment<Text>()[1].text() == "two"s);
+
+    SECTION("draws segment by segment")
+    {
+        CoutCapture capture;
+        shapes.draw();
+
+        REQUIRE(capture.str() == "Rendering text 'one' at: [1, 2]\n"
+                                 "Rendering text 'two' at: [5, 6]\n"
+                                 "Dot at: [3, 4]\n");
+    }
+}
+
+TEST_CASE("ShapeCollection - preserving order")
+{
+    ShapeCollection<Text, Dot> shapes{true};
+    shapes.add(Text{1, 2, "one"});
+    shapes.emplace<Dot>(3, 4);
+    shapes.add(Text{5, 6, "two"});
+
+    ShapeGroup group;
+    group.add(std::make_unique<Text>(1, 2, "one"));
+    group.add(std::make_unique<Dot>(3, 4));
+    group.add(std::make_unique<Text>(5, 6, "two"));
+
+    std::string expected;
+    {
+        CoutCapture capture;
+        group.draw();
+        expected = capture.str();
+    }
+
+    CoutCapture capture;
+    shapes.draw();
+    REQUIRE(capture.str() == expected);
+}
+
+TEST_CASE("ShapeCollection vs. ShapeGroup - drawing 1M shapes", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 1'000'000;
+
+    ShapeGroup group;
+    ShapeCollection<Text, Dot> collection;
+    collection.reserve(no_of_shapes);
+
+    for (int i = 0; i < no_of_shapes; ++i)
+    {
+        if (i % 4 == 0)
+        {
+            group.add(std::make_unique<Dot>(i, i));
+            collection.emplace<Dot>(i, i);
+        }
+        else
+        {
+            group.add(std::make_unique<Text>(i, i, "txt"));
+            collection.emplace<Text>(i, i, "txt");
+        }
+    }
+
+    NullBuffer null_buffer;
+    auto* previous = std::cout.rdbuf(&null_buffer);
+
+    BENCHMARK("ShapeGroup::draw")
+    {
+        group.draw();
+    };
+
+    BENCHMARK("ShapeCollection::draw")
+    {
+        collection.draw();
+    };
+
+    std::cout.rdbuf(previous);
+}
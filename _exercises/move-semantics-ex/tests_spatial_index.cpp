@@ -0,0 +1,164 @@
+#include "paragraph.hpp"
+#include "spatial_index.hpp"
+#include "test_helpers.hpp"
+
+#include <climits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+using namespace TestHelpers;
+
+TEST_CASE("UniformGrid")
+{
+    UniformGrid grid{10};
+    grid.insert(0, Rect::point(5, 5));
+    grid.insert(1, Rect::point(-5, -15));
+    grid.insert(2, Rect{0, 0, 35, 35}); // spans many cells
+
+    REQUIRE(grid.query(Rect{0, 0, 10, 10}) == std::vector<uint32_t>{0, 2});
+    REQUIRE(grid.query(Rect{-10, -20, 0, 0}) == std::vector<uint32_t>{1});
+    REQUIRE(grid.query(Rect{20, 20, 100, 100}) == std::vector<uint32_t>{2});
+    REQUIRE(grid.query(Rect{-100, -100, 100, 100}) == std::vector<uint32_t>{0, 1, 2});
+
+    grid.update(0, Rect::point(50, 50));
+    REQUIRE(grid.query(Rect{0, 0, 10, 10}) == std::vector<uint32_t>{2});
+    REQUIRE(grid.query(Rect{45, 45, 55, 55}) == std::vector<uint32_t>{0});
+
+    SECTION("unbounded items are candidates of every query")
+    {
+        grid.insert(3, Rect::unbounded());
+
+        REQUIRE(grid.query(Rect{45, 45, 55, 55}) == std::vector<uint32_t>{0, 3});
+        REQUIRE(grid.query(Rect{1000, 1000, 1001, 1001}) == std::vector<uint32_t>{3});
+
+        grid.update(3, Rect::point(1000, 1000));
+        REQUIRE(grid.query(Rect{45, 45, 55, 55}) == std::vector<uint32_t>{0});
+        REQUIRE(grid.query(Rect{1000, 1000, 1001, 1001}) == std::vector<uint32_t>{3});
+    }
+
+    SECTION("huge areas & coordinates near the limits of int")
+    {
+        UniformGrid fine{1};
+        fine.insert(0, Rect::point(0, 0));
+        fine.insert(1, Rect{INT_MAX - 2, INT_MAX - 2, INT_MAX, INT_MAX});
+        fine.insert(2, Rect{INT_MIN, INT_MIN, INT_MIN + 1, INT_MIN + 1});
+        fine.insert(3, Rect::point(INT_MAX, INT_MAX)); // empty bounds
+
+        // visits occupied cells, not ~2^64 cells of the area
+        REQUIRE(fine.query(Rect{INT_MIN, INT_MIN, INT_MAX, INT_MAX}) == std::vector<uint32_t>{0, 1, 2});
+        REQUIRE(fine.query(Rect{INT_MAX - 1, INT_MAX - 1, INT_MAX, INT_MAX}) == std::vector<uint32_t>{1});
+        REQUIRE(fine.query(Rect{1, 1, INT_MAX - 2, INT_MAX - 2}).empty());
+
+        fine.erase(1);
+        REQUIRE(fine.query(Rect{-1, -1, INT_MAX, INT_MAX}) == std::vector<uint32_t>{0});
+    }
+}
+
+namespace
+{
+    struct LegacyShape : Shape
+    {
+        void draw() const override
+        {
+        }
+    };
+}
+
+TEST_CASE("ShapeGroup - query")
+{
+    ShapeGroup group;
+    group.add(std::make_unique<Text>(0, 0, "a long label"));
+    group.add(std::make_unique<LegacyShape>());
+    group.add(std::make_unique<Text>(50, 50, "far"));
+
+    const Rect area{5, 0, 10, 1}; // overlaps chars of the first label, not its anchor
+
+    SECTION("without index")
+    {
+        REQUIRE(group.query(area) == std::vector<size_t>{0, 1});
+    }
+
+    SECTION("with index")
+    {
+        group.enable_spatial_index(4);
+        REQUIRE(group.query(area) == std::vector<size_t>{0, 1});
+    }
+
+    SECTION("bounds of text follow its length")
+    {
+        group.enable_spatial_index(4);
+        static_cast<Text&>(*group.shapes[0]).set_text("a");
+        REQUIRE(group.query(area) == std::vector<size_t>{1});
+    }
+}
+
+TEST_CASE("ShapeGroup - viewport culling")
+{
+    ShapeGroup group;
+    group.add(std::make_unique<Text>(10, 10, "visible"));
+    group.add(std::make_unique<Text>(500, 500, "hidden"));
+    group.enable_spatial_index(100);
+    group.add(std::make_unique<Text>(20, 20, "added"));
+
+    const Rect viewport{0, 0, 100, 100};
+
+    REQUIRE(group.query(viewport) == std::vector<size_t>{0, 2});
+
+    SECTION("moving shape updates index")
+    {
+        static_cast<Text&>(*group.shapes[1]).move_to(50, 50);
+        group.reindex(1);
+
+        REQUIRE(group.query(viewport) == std::vector<size_t>{0, 1, 2});
+    }
+
+    SECTION("draw_in")
+    {
+        CoutCapture capture;
+        group.draw_in(viewport);
+
+        REQUIRE(capture.str() == "Rendering text 'visible' at: [10, 10]\n"
+                                 "Rendering text 'added' at: [20, 20]\n");
+    }
+}
+
+TEST_CASE("ShapeGroup - draw_in small viewport of 10M shapes", "[.benchmark]")
+{
+    constexpr int no_of_shapes = 10'000'000;
+    constexpr int world_size = 100'000;
+
+    std::mt19937 rnd{42};
+    std::uniform_int_distribution<int> coordinate{0, world_size - 1};
+
+    ShapeGroup group;
+    group.reserve(no_of_shapes);
+    group.enable_spatial_index(256);
+    for (int i = 0; i < no_of_shapes; ++i)
+        group.add(std::make_unique<Text>(coordinate(rnd), coordinate(rnd), "txt"));
+
+    const Rect viewport{50'000, 50'000, 51'920, 51'080};
+
+    NullBuffer null_buffer;
+    auto* previous = std::cout.rdbuf(&null_buffer);
+
+    BENCHMARK("ShapeGroup::draw_in - spatial index")
+    {
+        group.draw_in(viewport);
+    };
+
+    BENCHMARK("visiting all shapes")
+    {
+        RenderCommandBuffer buffer;
+        for (const auto& s : group.shapes)
+            if (s->bounds().intersects(viewport))
+                s->record(buffer);
+        buffer.execute(std::cout);
+    };
+
+    std::cout.rdbuf(previous);
+}
@@ -0,0 +1,159 @@
+#include "paragraph.hpp"
+#include "text_index.hpp"
+
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+
+namespace
+{
+    // label of shape i - "common" in every shape, "even"/"odd", "tag<i % 1000>" and "id<i>"
+    std::string label(size_t i)
+    {
+        return "Common " + std::string(i % 2 ? "odd" : "even") + ", tag" + std::to_string(i % 1000) + " id" + std::to_string(i);
+    }
+}
+
+TEST_CASE("PostingList - same content as std::set")
+{
+    std::mt19937 rnd{42};
+    PostingList list;
+    std::set<uint32_t> expected;
+
+    for (uint32_t id = 0; id < 10'000; id += 1 + rnd() % 5)
+    {
+        list.add(id);
+        expected.insert(id);
+    }
+
+    for (int i = 0; i < 20'000; ++i)
+    {
+        const uint32_t id = rnd() % 12'000;
+        if (rnd() % 2)
+        {
+            list.add(id);
+            expected.insert(id);
+        }
+        else
+        {
+            list.remove(id);
+            expected.erase(id);
+        }
+
+        REQUIRE(list.contains(id) == expected.contains(id));
+    }
+
+    REQUIRE(list.size() == expected.size());
+    REQUIRE(list.ids() == std::vector<uint32_t>(expected.begin(), expected.end()));
+}
+
+TEST_CASE("TextIndex::tokenize")
+{
+    REQUIRE(TextIndex::tokenize("Hello, World! zażółć  x-1") == std::vector<std::string>{"hello", "world", "zażółć", "x", "1"});
+    REQUIRE(TextIndex::tokenize(" ,. ").empty());
+}
+
+TEST_CASE("ShapeGroup - text search")
+{
+    ShapeGroup scene;
+    std::vector<Text*> texts;
+    for (int i = 0; i < 3'000; ++i)
+    {
+        auto text = std::make_unique<Text>(i, i, label(i));
+        texts.push_back(text.get());
+        scene.add(std::move(text));
+    }
+
+    const auto check = [&] {
+        REQUIRE(scene.find_all({"tag7"}) == std::vector<size_t>{7, 1007, 2007});
+        REQUIRE(scene.find_all({"TAG7", "odd"}) == std::vector<size_t>{7, 1007, 2007});
+        REQUIRE(scene.find_all({"tag8", "odd"}).empty());
+        REQUIRE(scene.find_all({"id1", "missing"}).empty());
+        REQUIRE(scene.find_any({"id1", "id2999", "missing"}) == std::vector<size_t>{1, 2999});
+        REQUIRE(scene.find_all({"common"}).size() == 3'000);
+    };
+
+    SECTION("without index")
+    {
+        check();
+    }
+
+    SECTION("with index")
+    {
+        scene.enable_text_index();
+        REQUIRE(scene.has_text_index());
+        check();
+    }
+
+    SECTION("index is updated by add() and set_text()")
+    {
+        scene.enable_text_index();
+
+        scene.add(std::make_unique<Text>(0, 0, "new tag7"));
+        texts[1007]->set_text("changed");
+        texts[1007]->move_to(1, 1);
+        texts[1]->set_text("tag7 again");
+
+        REQUIRE(scene.find_all({"tag7"}) == std::vector<size_t>{1, 7, 2007, 3000});
+        REQUIRE(scene.find_all({"changed"}) == std::vector<size_t>{1007});
+        REQUIRE(scene.find_all({"id1"}).empty());
+    }
+}
+
+TEST_CASE("TextIndex - queries over 10M shapes", "[.benchmark]")
+{
+    constexpr uint32_t no_of_shapes = 10'000'000;
+
+    TextIndex index;
+    for (uint32_t i = 0; i < no_of_shapes; ++i)
+        index.update(i, "Common " + std::string(i % 2 ? "odd" : "even") + " tag" + std::to_string(i % 100'000));
+
+    BENCHMARK("find_all - rare tag")
+    {
+        return index.find_all({"tag42"});
+    };
+
+    BENCHMARK("find_all - rare tag & common word")
+    {
+        return index.find_all({"tag42", "odd"});
+    };
+
+    BENCHMARK("find_any - 10 rare tags")
+    {
+        return index.find_any({"tag1", "tag2", "tag3", "tag4", "tag5", "tag6", "tag7", "tag8", "tag9", "tag10"});
+    };
+
+    BENCHMARK("find_all - common word (decodes 5M ids)")
+    {
+        return index.find_all({"odd"});
+    };
+}
+
+TEST_CASE("ShapeGroup - text search vs. scan of 1M shapes", "[.benchmark]")
+{
+    ShapeGroup scene;
+    for (size_t i = 0; i < 1'000'000; ++i)
+        scene.add(std::make_unique<Text>(0, 0, label(i)));
+
+    BENCHMARK("scan of text() of every shape")
+    {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < scene.shapes.size(); ++i)
+            if (static_cast<const Text&>(*scene.shapes[i]).text().find("tag42 ") != std::string::npos)
+                result.push_back(i);
+        return result;
+    };
+
+    scene.enable_text_index();
+
+    BENCHMARK("ShapeGroup::find_all - text index")
+    {
+        return scene.find_all({"tag42"});
+    };
+}
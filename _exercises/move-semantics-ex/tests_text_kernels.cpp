@@ -0,0 +1,185 @@
+#include "paragraph.hpp"
+#include "text_kernels.hpp"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+
+namespace
+{
+    std::string random_text(size_t size, std::mt19937& rnd, char from = 'a', char to = 'd')
+    {
+        std::uniform_int_distribution<int> distribution{from, to};
+        std::string text(size, ' ');
+        for (auto& c : text)
+            c = static_cast<char>(distribution(rnd));
+        return text;
+    }
+
+    std::string utf8_labels(size_t size, std::mt19937& rnd)
+    {
+        const std::vector<std::string> words = {"label", "zażółć", "gęślą", "jaźń", "€uro", "日本語", "🙂", "text"};
+        std::string text;
+        while (text.size() < size)
+            text += words[rnd() % words.size()] + ' ';
+        return text;
+    }
+}
+
+TEST_CASE("TextKernels::find - same results as std::string_view::find")
+{
+    std::mt19937 rnd{42};
+
+    for (size_t size : {0u, 1u, 15u, 16u, 17u, 100u, 1000u})
+    {
+        const std::string text = random_text(size, rnd);
+        const std::string_view view{text};
+
+        for (size_t pos = 0; pos <= size; pos += 7)
+        {
+            for (char c : {'a', 'd', 'z'})
+                REQUIRE(TextKernels::find(view, c, pos) == view.find(c, pos));
+
+            for (const char* needle : {"", "a", "ab", "abc", "dcba", "abcdabcd", "zz"})
+                REQUIRE(TextKernels::find(view, needle, pos) == view.find(needle, pos));
+        }
+    }
+}
+
+TEST_CASE("TextKernels::is_valid_utf8")
+{
+    const std::string ascii(100, 'a');
+
+    REQUIRE(TextKernels::is_valid_utf8(""));
+    REQUIRE(TextKernels::is_valid_utf8(ascii));
+    REQUIRE(TextKernels::is_valid_utf8(ascii + "zażółć gęślą jaźń" + ascii));
+    REQUIRE(TextKernels::is_valid_utf8("\xE2\x82\xAC \xF0\x9F\x99\x82 \xF4\x8F\xBF\xBF"));
+
+    for (std::string invalid : {
+             "\x80",             // unexpected continuation
+             "\xC0\xAF",         // overlong
+             "\xE0\x80\xAF",     // overlong
+             "\xED\xA0\x80",     // surrogate
+             "\xF4\x90\x80\x80", // above U+10FFFF
+             "\xF5\x80\x80\x80", // invalid lead
+             "\xE2\x82",         // truncated
+             "\xE2\x82" "a",     // truncated before ASCII
+         })
+    {
+        REQUIRE_FALSE(TextKernels::is_valid_utf8(invalid));
+        REQUIRE_FALSE(TextKernels::is_valid_utf8(ascii + invalid));
+        REQUIRE_FALSE(TextKernels::is_valid_utf8(ascii + invalid + ascii));
+    }
+}
+
+TEST_CASE("TextKernels::is_valid_utf8 - same results as scalar validation")
+{
+    std::mt19937 rnd{42};
+    std::string labels = utf8_labels(10'000, rnd);
+
+    REQUIRE(TextKernels::is_valid_utf8(labels));
+
+    for (int i = 0; i < 1'000; ++i)
+    {
+        std::string corrupted = labels;
+        corrupted[rnd() % corrupted.size()] = static_cast<char>(rnd());
+
+        REQUIRE(TextKernels::is_valid_utf8(corrupted) == TextKernels::Scalar::is_valid_utf8(corrupted));
+    }
+}
+
+TEST_CASE("Paragraph & Text - search and validation")
+{
+    Text text{1, 2, "Hello, world - zażółć!"};
+
+    REQUIRE(text.find('o') == 4);
+    REQUIRE(text.find('o', 5) == 8);
+    REQUIRE(text.find("zaż") == 15);
+    REQUIRE(text.find('x') == LegacyCode::Paragraph::npos);
+    REQUIRE(text.is_valid_utf8());
+
+    text.set_text("\xC0\xAF");
+    REQUIRE_FALSE(text.is_valid_utf8());
+
+    LegacyCode::Paragraph rope{std::string(5'000, 'a').append("needle").c_str()};
+    rope.use_rope();
+    REQUIRE(rope.find("needle") == 5'000);
+}
+
+TEST_CASE("TextKernels - throughput vs. libc & std::string", "[.benchmark]")
+{
+    std::mt19937 rnd{42};
+    const std::string text = random_text(1'000'000, rnd) + "needle";
+    const std::string labels = utf8_labels(1'000'000, rnd);
+
+    BENCHMARK("std::strlen")
+    {
+        return std::strlen(text.c_str());
+    };
+
+    BENCHMARK("std::memchr")
+    {
+        return std::memchr(text.data(), 'n', text.size());
+    };
+
+    BENCHMARK("std::string::find(char)")
+    {
+        return text.find('n');
+    };
+
+    BENCHMARK("TextKernels::find(char)")
+    {
+        return TextKernels::find(text, 'n');
+    };
+
+    BENCHMARK("std::strstr")
+    {
+        return std::strstr(text.c_str(), "needle");
+    };
+
+    BENCHMARK("std::string::find(string)")
+    {
+        return text.find("needle");
+    };
+
+    BENCHMARK("TextKernels::find(string)")
+    {
+        return TextKernels::find(text, "needle");
+    };
+
+    // first char of needle is frequent in text - std::string::find stops at every candidate
+    BENCHMARK("std::string::find(string) - frequent first char")
+    {
+        return text.find("abcdz");
+    };
+
+    BENCHMARK("TextKernels::find(string) - frequent first char")
+    {
+        return TextKernels::find(text, "abcdz");
+    };
+
+    BENCHMARK("TextKernels::Scalar::is_valid_utf8 - UTF-8 labels")
+    {
+        return TextKernels::Scalar::is_valid_utf8(labels);
+    };
+
+    BENCHMARK("TextKernels::is_valid_utf8 - UTF-8 labels")
+    {
+        return TextKernels::is_valid_utf8(labels);
+    };
+
+    BENCHMARK("TextKernels::Scalar::is_valid_utf8 - ASCII")
+    {
+        return TextKernels::Scalar::is_valid_utf8(text);
+    };
+
+    BENCHMARK("TextKernels::is_valid_utf8 - ASCII")
+    {
+        return TextKernels::is_valid_utf8(text);
+    };
+}
@@ -0,0 +1,202 @@
+#include "paragraph.hpp"
+#include "text_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+
+TEST_CASE("TextPool")
+{
+    TextPool pool;
+
+    SharedText a = pool.intern("label");
+    SharedText b = pool.intern(std::string("label"));
+    SharedText c = pool.intern("other");
+
+    REQUIRE(a.c_str() == b.c_str());
+    REQUIRE(a.c_str() != c.c_str());
+    REQUIRE(a.view() == "label");
+    REQUIRE(a.use_count() == 2);
+    REQUIRE(pool.size() == 2);
+
+    SECTION("texts are released with last reference")
+    {
+        c = SharedText{};
+        REQUIRE(pool.size() == 1);
+    }
+
+    SECTION("concurrent interning")
+    {
+        std::vector<const char*> results(8);
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i = 0; i < results.size(); ++i)
+                threads.emplace_back([&, i] {
+                    for (int n = 0; n < 1000; ++n)
+                        pool.intern("text#" + std::to_string(n));
+                    results[i] = pool.intern("label").c_str();
+                });
+        }
+
+        REQUIRE(std::all_of(results.begin(), results.end(), [&](auto p) { return p == a.c_str(); }));
+    }
+}
+
+TEST_CASE("Text - flyweight mode")
+{
+    Text t1 = Text::flyweight(1, 2, "a long label shared by many shapes");
+    Text t2 = Text::flyweight(3, 4, "a long label shared by many shapes");
+
+    REQUIRE(t1.is_flyweight());
+    REQUIRE(t1.paragraph().get_paragraph() == t2.paragraph().get_paragraph());
+    REQUIRE(t1.text() == "a long label shared by many shapes"s);
+
+    SECTION("copy shares text")
+    {
+        Text copy = t1;
+        REQUIRE(copy.paragraph().get_paragraph() == t1.paragraph().get_paragraph());
+    }
+
+    SECTION("set_text re-points")
+    {
+        t1.set_text("another label");
+
+        REQUIRE(t1.is_flyweight());
+        REQUIRE(t1.text() == "another label"s);
+        REQUIRE(t2.text() == "a long label shared by many shapes"s);
+        REQUIRE(t1.paragraph().get_paragraph() == Text::flyweight(0, 0, "another label").paragraph().get_paragraph());
+    }
+
+    SECTION("set_paragraph on shared paragraph makes a private copy")
+    {
+        LegacyCode::Paragraph p = t1.paragraph();
+        p.set_paragraph(p.get_paragraph() + 2);
+
+        REQUIRE_FALSE(p.is_shared());
+        REQUIRE(p.get_paragraph() == "long label shared by many shapes"s);
+    }
+
+    SECTION("assigning empty text to shared paragraph does not modify shared text")
+    {
+        LegacyCode::Paragraph p = t1.paragraph();
+        p.set_paragraph("");
+
+        REQUIRE_FALSE(p.is_shared());
+        REQUIRE(p.get_paragraph() == ""s);
+        REQUIRE(t2.text() == "a long label shared by many shapes"s);
+
+        LegacyCode::Paragraph erased = t2.paragraph();
+        erased.erase(0, erased.size());
+        REQUIRE(erased.size() == 0);
+        REQUIRE(t1.text() == "a long label shared by many shapes"s);
+    }
+}
+
+TEST_CASE("Text - flyweight set_text interns in the pool of the text")
+{
+    TextPool pool;
+    Text t = Text::flyweight(1, 2, "label", pool);
+
+    t.set_text("another label");
+
+    REQUIRE(pool.intern("another label").c_str() == t.paragraph().get_paragraph());
+
+    Text copy = t;
+    copy.set_text("third label");
+    REQUIRE(pool.intern("third label").c_str() == copy.paragraph().get_paragraph());
+}
+
+namespace
+{
+    // Zipf-distributed ranks 0..n-1 with exponent 1
+    class ZipfDistribution
+    {
+        std::vector<double> cdf_;
+
+    public:
+        explicit ZipfDistribution(size_t n)
+            : cdf_(n)
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                cdf_[i] = (sum += 1.0 / static_cast<double>(i + 1));
+            for (auto& p : cdf_)
+                p /= sum;
+        }
+
+        template <typename TRandom>
+        size_t operator()(TRandom& rnd)
+        {
+            const double p = std::uniform_real_distribution<double>{0.0, 1.0}(rnd);
+            return std::min<size_t>(std::lower_bound(cdf_.begin(), cdf_.end(), p) - cdf_.begin(), cdf_.size() - 1);
+        }
+    };
+}
+
+TEST_CASE("Text - flyweight on Zipf workload", "[.benchmark]")
+{
+    constexpr size_t no_of_shapes = 1'000'000;
+    constexpr size_t no_of_labels = 10'000;
+
+    std::vector<std::string> labels;
+    for (size_t i = 0; i < no_of_labels; ++i)
+        labels.push_back("Label of a shape in the scene #" + std::to_string(i));
+
+    std::mt19937_64 rnd{42};
+    ZipfDistribution zipf{no_of_labels};
+    std::vector<size_t> workload(no_of_shapes);
+    for (auto& rank : workload)
+        rank = zipf(rnd);
+
+    std::vector<Text> owning;
+    std::vector<Text> flyweights;
+    owning.reserve(no_of_shapes);
+    flyweights.reserve(no_of_shapes);
+    for (size_t rank : workload)
+    {
+        owning.emplace_back(0, 0, labels[rank]);
+        flyweights.push_back(Text::flyweight(0, 0, labels[rank]));
+    }
+
+    size_t owning_bytes = 0;
+    for (const auto& t : owning)
+        owning_bytes += t.paragraph().capacity() + 1;
+
+    size_t shared_bytes = 0;
+    std::vector<bool> seen(no_of_labels);
+    for (size_t rank : workload)
+        if (!seen[rank])
+        {
+            seen[rank] = true;
+            shared_bytes += labels[rank].size() + 1 + 2 * sizeof(void*); // text + control block
+        }
+
+    std::cout << "Text memory for " << no_of_shapes << " shapes: owning: " << owning_bytes / 1024 << " KB"
+              << ", flyweight: " << shared_bytes / 1024 << " KB\n";
+
+    BENCHMARK("construct owning Text")
+    {
+        std::vector<Text> texts;
+        texts.reserve(no_of_shapes);
+        for (size_t rank : workload)
+            texts.emplace_back(0, 0, labels[rank]);
+        return texts.size();
+    };
+
+    BENCHMARK("construct flyweight Text")
+    {
+        std::vector<Text> texts;
+        texts.reserve(no_of_shapes);
+        for (size_t rank : workload)
+            texts.push_back(Text::flyweight(0, 0, labels[rank]));
+        return texts.size();
+    };
+}
@@ -0,0 +1,328 @@
+#ifndef TEXT_INDEX_HPP_
+#define TEXT_INDEX_HPP_
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Sorted set of ids compressed as varint deltas in blocks of block_size ids
+// - ids added in increasing order are appended to the compressed data
+// - other changes are kept in small sorted pending lists and merged into the compressed data from time to time
+// - every block starts with its first id, so lookups decode at most one block
+class PostingList
+{
+public:
+    static constexpr uint32_t block_size = 128;
+
+private:
+    struct Block
+    {
+        uint32_t first_id;
+        uint32_t offset; // of the first id after first_id
+        uint32_t count;
+    };
+
+    std::vector<uint8_t> bytes_;
+    std::vector<Block> blocks_;
+    uint32_t last_id_ = 0;
+    uint32_t compressed_count_ = 0;
+    std::vector<uint32_t> added_;   // not in compressed data
+    std::vector<uint32_t> removed_; // in compressed data
+
+public:
+    size_t size() const
+    {
+        return compressed_count_ + added_.size() - removed_.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    void add(uint32_t id)
+    {
+        if (auto pos = std::lower_bound(removed_.begin(), removed_.end(), id); pos != removed_.end() && *pos == id)
+        {
+            removed_.erase(pos);
+            return;
+        }
+
+        if (added_.empty() && (compressed_count_ == 0 || id > last_id_))
+        {
+            append(id);
+            return;
+        }
+
+        if (compressed_contains(id))
+            return;
+        if (auto pos = std::lower_bound(added_.begin(), added_.end(), id); pos == added_.end() || *pos != id)
+            added_.insert(pos, id);
+        compact_if_needed();
+    }
+
+    void remove(uint32_t id)
+    {
+        if (auto pos = std::lower_bound(added_.begin(), added_.end(), id); pos != added_.end() && *pos == id)
+        {
+            added_.erase(pos);
+            return;
+        }
+
+        if (!compressed_contains(id))
+            return;
+        if (auto pos = std::lower_bound(removed_.begin(), removed_.end(), id); pos == removed_.end() || *pos != id)
+            removed_.insert(pos, id);
+        compact_if_needed();
+    }
+
+    bool contains(uint32_t id) const
+    {
+        if (std::binary_search(added_.begin(), added_.end(), id))
+            return true;
+        return compressed_contains(id) && !std::binary_search(removed_.begin(), removed_.end(), id);
+    }
+
+    // all ids in increasing order
+    std::vector<uint32_t> ids() const
+    {
+        std::vector<uint32_t> compressed;
+        compressed.reserve(compressed_count_);
+        for (const auto& block : blocks_)
+            decode(block, [&compressed](uint32_t id) { compressed.push_back(id); return true; });
+
+        if (added_.empty() && removed_.empty())
+            return compressed;
+
+        std::vector<uint32_t> remaining;
+        remaining.reserve(compressed.size());
+        std::set_difference(compressed.begin(), compressed.end(), removed_.begin(), removed_.end(), std::back_inserter(remaining));
+
+        std::vector<uint32_t> result;
+        result.reserve(remaining.size() + added_.size());
+        std::merge(remaining.begin(), remaining.end(), added_.begin(), added_.end(), std::back_inserter(result));
+        return result;
+    }
+
+    size_t memory_usage() const
+    {
+        return sizeof(*this) + bytes_.capacity() + blocks_.capacity() * sizeof(Block)
+            + (added_.capacity() + removed_.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    void append(uint32_t id)
+    {
+        if (compressed_count_ % block_size == 0)
+            blocks_.push_back(Block{id, static_cast<uint32_t>(bytes_.size()), 1});
+        else
+        {
+            write_varint(id - last_id_);
+            ++blocks_.back().count;
+        }
+        last_id_ = id;
+        ++compressed_count_;
+    }
+
+    // pending lists are merged when they get longer than 1/8 of compressed data
+    void compact_if_needed()
+    {
+        if (added_.size() + removed_.size() <= std::max<size_t>(16, compressed_count_ / 8))
+            return;
+
+        const std::vector<uint32_t> all = ids();
+        *this = PostingList{};
+        for (uint32_t id : all)
+            append(id);
+    }
+
+    bool compressed_contains(uint32_t id) const
+    {
+        auto block = std::upper_bound(blocks_.begin(), blocks_.end(), id, [](uint32_t id, const Block& b) { return id < b.first_id; });
+        if (block == blocks_.begin())
+            return false;
+        --block;
+
+        bool found = false;
+        decode(*block, [id, &found](uint32_t current) {
+            found = (current == id);
+            return current < id;
+        });
+        return found;
+    }
+
+    // calls f(id) for ids of block while f returns true
+    template <typename F>
+    void decode(const Block& block, F&& f) const
+    {
+        uint32_t id = block.first_id;
+        size_t offset = block.offset;
+        if (!f(id))
+            return;
+        for (uint32_t i = 1; i < block.count; ++i)
+        {
+            id += read_varint(offset);
+            if (!f(id))
+                return;
+        }
+    }
+
+    void write_varint(uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            bytes_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes_.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t read_varint(size_t& offset) const
+    {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            const uint8_t byte = bytes_[offset++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+    }
+};
+
+// Inverted index: token -> PostingList of ids of shapes containing the token
+// - tokens are runs of chars other than ASCII whitespace and punctuation, ASCII letters are lowercased
+// - tokens of every id are remembered, so update() changes only posting lists of added/removed tokens
+class TextIndex
+{
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view txt) const
+        {
+            return std::hash<std::string_view>{}(txt);
+        }
+    };
+
+    using Postings = std::unordered_map<std::string, PostingList, StringHash, std::equal_to<>>;
+
+    Postings postings_;
+    std::vector<std::vector<Postings::value_type*>> tokens_of_; // sorted by address
+
+public:
+    static std::vector<std::string> tokenize(std::string_view text)
+    {
+        std::vector<std::string> tokens;
+        std::string token;
+
+        for (char c : text)
+        {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte < 0x80 && !std::isalnum(byte))
+            {
+                if (!token.empty())
+                    tokens.push_back(std::exchange(token, {}));
+                continue;
+            }
+            token += (byte < 0x80) ? static_cast<char>(std::tolower(byte)) : c;
+        }
+        if (!token.empty())
+            tokens.push_back(std::move(token));
+
+        return tokens;
+    }
+
+    // sets tokens of id to tokens of text
+    void update(uint32_t id, std::string_view text)
+    {
+        if (id >= tokens_of_.size())
+            tokens_of_.resize(id + 1);
+
+        std::vector<Postings::value_type*> tokens;
+        for (auto& token : tokenize(text))
+        {
+            auto pos = postings_.find(token);
+            if (pos == postings_.end())
+                pos = postings_.emplace(std::move(token), PostingList{}).first;
+            tokens.push_back(&*pos);
+        }
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+        auto& previous = tokens_of_[id];
+        if (tokens == previous)
+            return;
+
+        std::vector<Postings::value_type*> changes;
+        std::set_difference(previous.begin(), previous.end(), tokens.begin(), tokens.end(), std::back_inserter(changes));
+        for (auto* entry : changes)
+            entry->second.remove(id);
+
+        changes.clear();
+        std::set_difference(tokens.begin(), tokens.end(), previous.begin(), previous.end(), std::back_inserter(changes));
+        for (auto* entry : changes)
+            entry->second.add(id);
+
+        previous = std::move(tokens);
+    }
+
+    // ids containing all words (tokens of words)
+    std::vector<uint32_t> find_all(const std::vector<std::string_view>& words) const
+    {
+        std::vector<const PostingList*> lists;
+        for (auto word : words)
+            for (const auto& token : tokenize(word))
+            {
+                auto pos = postings_.find(token);
+                if (pos == postings_.end() || pos->second.empty())
+                    return {};
+                lists.push_back(&pos->second);
+            }
+
+        if (lists.empty())
+            return {};
+
+        // the shortest list is decoded, other lists are only probed
+        std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) { return a->size() < b->size(); });
+
+        std::vector<uint32_t> result = lists.front()->ids();
+        for (size_t i = 1; i < lists.size() && !result.empty(); ++i)
+            std::erase_if(result, [list = lists[i]](uint32_t id) { return !list->contains(id); });
+        return result;
+    }
+
+    // ids containing any of words
+    std::vector<uint32_t> find_any(const std::vector<std::string_view>& words) const
+    {
+        std::vector<uint32_t> result;
+        for (auto word : words)
+            for (const auto& token : tokenize(word))
+            {
+                auto pos = postings_.find(token);
+                if (pos == postings_.end())
+                    continue;
+
+                const std::vector<uint32_t> ids = pos->second.ids();
+                std::vector<uint32_t> merged;
+                merged.reserve(result.size() + ids.size());
+                std::set_union(result.begin(), result.end(), ids.begin(), ids.end(), std::back_inserter(merged));
+                result = std::move(merged);
+            }
+        return result;
+    }
+
+    size_t no_of_tokens() const
+    {
+        return postings_.size();
+    }
+};
+
+#endif /*TEXT_INDEX_HPP_*/
@@ -0,0 +1,213 @@
+#ifndef TEXT_KERNELS_HPP_
+#define TEXT_KERNELS_HPP_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_KERNELS_SSE2 1
+#endif
+
+// Kernels over text - SSE2 processes 16-64 bytes per step, scalar versions handle tails and targets without SSE2
+// - find() beats std::string_view::find only when the first char of needle is frequent in text,
+//   libc strlen/memchr are faster than an SSE2 loop - Paragraph uses them for length and search
+namespace TextKernels
+{
+    constexpr size_t npos = static_cast<size_t>(-1);
+
+    // DFA accepting well-formed UTF-8 (Unicode table 3-7: no overlongs, surrogates or code points above U+10FFFF)
+    // - states are multiples of 6 and a row packs the next state of every state in 6 bits,
+    //   so a step is a table lookup by byte and a shift - the dependency chain does not include a load
+    namespace Utf8Dfa
+    {
+        enum State : uint64_t
+        {
+            accept = 0,
+            reject = 6,
+            need_1 = 12, // continuation bytes
+            need_2 = 18,
+            need_3 = 24,
+            after_e0 = 30, // A0..BF, then 1 continuation byte
+            after_ed = 36, // 80..9F, then 1 continuation byte
+            after_f0 = 42, // 90..BF, then 2 continuation bytes
+            after_f4 = 48  // 80..8F, then 2 continuation bytes
+        };
+
+        constexpr uint64_t next(uint64_t state, uint8_t byte)
+        {
+            const auto in = [byte](uint8_t first, uint8_t last) { return byte >= first && byte <= last; };
+
+            switch (state)
+            {
+            case accept:
+                if (byte < 0x80)
+                    return accept;
+                if (in(0xC2, 0xDF))
+                    return need_1;
+                if (byte == 0xE0)
+                    return after_e0;
+                if (byte == 0xED)
+                    return after_ed;
+                if (in(0xE1, 0xEF))
+                    return need_2;
+                if (byte == 0xF0)
+                    return after_f0;
+                if (byte == 0xF4)
+                    return after_f4;
+                if (in(0xF1, 0xF3))
+                    return need_3;
+                return reject;
+            case need_1:
+                return in(0x80, 0xBF) ? accept : reject;
+            case need_2:
+                return in(0x80, 0xBF) ? need_1 : reject;
+            case need_3:
+                return in(0x80, 0xBF) ? need_2 : reject;
+            case after_e0:
+                return in(0xA0, 0xBF) ? need_1 : reject;
+            case after_ed:
+                return in(0x80, 0x9F) ? need_1 : reject;
+            case after_f0:
+                return in(0x90, 0xBF) ? need_2 : reject;
+            case after_f4:
+                return in(0x80, 0x8F) ? need_2 : reject;
+            default:
+                return reject;
+            }
+        }
+
+        constexpr std::array<uint64_t, 256> make_rows()
+        {
+            std::array<uint64_t, 256> rows{};
+            for (unsigned byte = 0; byte < 256; ++byte)
+                for (uint64_t state = accept; state <= after_f4; state += 6)
+                    rows[byte] |= next(state, static_cast<uint8_t>(byte)) << state;
+            return rows;
+        }
+
+        inline constexpr std::array<uint64_t, 256> rows = make_rows();
+
+        inline uint64_t run(uint64_t state, const char* data, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+                state = (rows[static_cast<uint8_t>(data[i])] >> state) & 63;
+            return state;
+        }
+    }
+
+    namespace Scalar
+    {
+        inline size_t find(std::string_view text, char c, size_t pos = 0)
+        {
+            for (size_t i = pos; i < text.size(); ++i)
+                if (text[i] == c)
+                    return i;
+            return npos;
+        }
+
+        inline bool is_valid_utf8(std::string_view text)
+        {
+            return Utf8Dfa::run(Utf8Dfa::accept, text.data(), text.size()) == Utf8Dfa::accept;
+        }
+    }
+
+    // position of the first c at or after pos or npos
+    inline size_t find(std::string_view text, char c, size_t pos = 0)
+    {
+#ifdef TEXT_KERNELS_SSE2
+        const __m128i pattern = _mm_set1_epi8(c);
+        for (; pos + 64 <= text.size(); pos += 64)
+        {
+            const auto* block = reinterpret_cast<const __m128i*>(text.data() + pos);
+            const __m128i any = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(block), pattern), _mm_cmpeq_epi8(_mm_loadu_si128(block + 1), pattern)),
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(block + 2), pattern), _mm_cmpeq_epi8(_mm_loadu_si128(block + 3), pattern)));
+            if (_mm_movemask_epi8(any) != 0)
+                break;
+        }
+
+        for (; pos + 16 <= text.size(); pos += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+            if (mask != 0)
+                return pos + std::countr_zero(mask);
+        }
+#endif
+        return Scalar::find(text, c, pos);
+    }
+
+    // position of the first occurrence of needle at or after pos or npos
+    // - 16 candidate positions are filtered at once by comparing the first and the last char of needle
+    inline size_t find(std::string_view text, std::string_view needle, size_t pos = 0)
+    {
+        if (needle.size() > text.size() || pos > text.size() - needle.size())
+            return npos;
+        if (needle.empty())
+            return pos;
+        if (needle.size() == 1)
+            return find(text, needle.front(), pos);
+
+        const size_t last_start = text.size() - needle.size();
+        const size_t last_offset = needle.size() - 1;
+
+#ifdef TEXT_KERNELS_SSE2
+        const __m128i first = _mm_set1_epi8(needle.front());
+        const __m128i last = _mm_set1_epi8(needle.back());
+        const auto candidates = [&](size_t offset) {
+            const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+            const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset + last_offset));
+            return static_cast<uint64_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+        };
+
+        for (; pos + 64 <= last_start + 1; pos += 64)
+        {
+            uint64_t mask = candidates(pos) | candidates(pos + 16) << 16 | candidates(pos + 32) << 32 | candidates(pos + 48) << 48;
+            while (mask != 0)
+            {
+                const size_t candidate = pos + std::countr_zero(mask);
+                if (std::memcmp(text.data() + candidate + 1, needle.data() + 1, needle.size() - 2) == 0)
+                    return candidate;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; pos <= last_start; ++pos)
+        {
+            if (text[pos] == needle.front() && text[pos + last_offset] == needle.back()
+                && std::memcmp(text.data() + pos + 1, needle.data() + 1, needle.size() - 2) == 0)
+                return pos;
+        }
+        return npos;
+    }
+
+    // blocks of 64 ASCII bytes are skipped at once when no multibyte sequence is open, other bytes go through Utf8Dfa
+    inline bool is_valid_utf8(std::string_view text)
+    {
+        uint64_t state = Utf8Dfa::accept;
+        size_t pos = 0;
+#ifdef TEXT_KERNELS_SSE2
+        for (; pos + 64 <= text.size(); pos += 64)
+        {
+            const auto* block = reinterpret_cast<const __m128i*>(text.data() + pos);
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(block), _mm_loadu_si128(block + 1)),
+                _mm_or_si128(_mm_loadu_si128(block + 2), _mm_loadu_si128(block + 3)));
+
+            if (_mm_movemask_epi8(any) != 0 || state != Utf8Dfa::accept)
+            {
+                state = Utf8Dfa::run(state, text.data() + pos, 64);
+                if (state == Utf8Dfa::reject)
+                    return false;
+            }
+        }
+#endif
+        return Utf8Dfa::run(state, text.data() + pos, text.size() - pos) == Utf8Dfa::accept;
+    }
+}
+
+#endif /*TEXT_KERNELS_HPP_*/
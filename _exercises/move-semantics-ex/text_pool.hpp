@@ -0,0 +1,146 @@
+#ifndef TEXT_POOL_HPP_
+#define TEXT_POOL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Immutable, reference counted, null-terminated text
+// - owner of the memory is kept alive by shared_ptr (aliasing constructor allows texts inside bigger blocks)
+class SharedText
+{
+    std::shared_ptr<const char> data_;
+    size_t size_ = 0;
+
+public:
+    SharedText() = default;
+
+    // data must point to size chars followed by '\0'
+    SharedText(std::shared_ptr<const char> data, size_t size)
+        : data_{std::move(data)}
+        , size_{size}
+    {
+    }
+
+    static SharedText from(std::string_view text)
+    {
+        auto block = std::make_shared<char[]>(text.size() + 1);
+        std::memcpy(block.get(), text.data(), text.size());
+        block[text.size()] = '\0';
+
+        return SharedText{std::shared_ptr<const char>{block, block.get()}, text.size()};
+    }
+
+    const char* c_str() const
+    {
+        return data_.get();
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    std::string_view view() const
+    {
+        return data_ ? std::string_view{data_.get(), size_} : std::string_view{};
+    }
+
+    long use_count() const
+    {
+        return data_.use_count();
+    }
+
+    explicit operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+    const std::shared_ptr<const char>& data() const
+    {
+        return data_;
+    }
+};
+
+// Concurrent intern table - equal texts share one immutable SharedText block
+// - table is split into shards with separate mutexes
+// - table keeps only weak references - blocks are released with the last text using them
+class TextPool
+{
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view txt) const
+        {
+            return std::hash<std::string_view>{}(txt);
+        }
+    };
+
+    struct Entry
+    {
+        std::weak_ptr<const char> data;
+        size_t size;
+    };
+
+    struct Shard
+    {
+        std::mutex mtx;
+        std::unordered_map<std::string, Entry, StringHash, std::equal_to<>> texts;
+        size_t purge_threshold = 64;
+    };
+
+    static constexpr size_t no_of_shards = 16;
+    std::array<Shard, no_of_shards> shards_;
+
+public:
+    static TextPool& global()
+    {
+        static TextPool pool;
+        return pool;
+    }
+
+    SharedText intern(std::string_view text)
+    {
+        Shard& shard = shards_[StringHash{}(text) % no_of_shards];
+        std::lock_guard lk{shard.mtx};
+
+        if (auto pos = shard.texts.find(text); pos != shard.texts.end())
+        {
+            if (auto data = pos->second.data.lock())
+                return SharedText{std::move(data), pos->second.size};
+        }
+
+        if (shard.texts.size() >= shard.purge_threshold)
+        {
+            std::erase_if(shard.texts, [](const auto& item) { return item.second.data.expired(); });
+            shard.purge_threshold = std::max<size_t>(64, 2 * shard.texts.size());
+        }
+
+        SharedText shared = SharedText::from(text);
+        shard.texts.insert_or_assign(std::string(text), Entry{shared.data(), shared.size()});
+
+        return shared;
+    }
+
+    // number of distinct texts that are still alive
+    size_t size()
+    {
+        size_t count = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lk{shard.mtx};
+            for (const auto& [text, entry] : shard.texts)
+                count += !entry.data.expired();
+        }
+        return count;
+    }
+};
+
+#endif /*TEXT_POOL_HPP_*/
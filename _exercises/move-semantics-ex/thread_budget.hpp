@@ -0,0 +1,88 @@
+#ifndef THREAD_BUDGET_HPP_
+#define THREAD_BUDGET_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Number of threads that may still be started by a parallel algorithm
+// - shared by nested parallel calls, so together they never use more than the initial number of threads
+class ThreadBudget
+{
+    std::atomic<int> available_;
+
+public:
+    // calling thread is included in no_of_threads
+    explicit ThreadBudget(unsigned no_of_threads = std::thread::hardware_concurrency())
+        : available_{static_cast<int>(std::max(no_of_threads, 1u)) - 1}
+    {
+    }
+
+    ThreadBudget(const ThreadBudget&) = delete;
+    ThreadBudget& operator=(const ThreadBudget&) = delete;
+
+    // returns number of acquired threads - from 0 to wanted
+    unsigned try_acquire(unsigned wanted)
+    {
+        int available = available_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const int acquired = std::min(available, static_cast<int>(wanted));
+            if (acquired <= 0)
+                return 0;
+            if (available_.compare_exchange_weak(available, available - acquired, std::memory_order_relaxed))
+                return static_cast<unsigned>(acquired);
+        }
+    }
+
+    void release(unsigned count)
+    {
+        available_.fetch_add(static_cast<int>(count), std::memory_order_relaxed);
+    }
+
+    unsigned available() const
+    {
+        return static_cast<unsigned>(std::max(available_.load(std::memory_order_relaxed), 0));
+    }
+};
+
+// Splits [0, size) into consecutive chunks of at least min_chunk_size items (as many as budget allows)
+// and calls f(first, last, result) for each chunk concurrently - results are returned in order of chunks
+template <typename TResult, typename F>
+std::vector<TResult> parallel_chunks(ThreadBudget& budget, size_t size, size_t min_chunk_size, F&& f)
+{
+    const size_t max_chunks = std::max<size_t>(size / std::max<size_t>(min_chunk_size, 1), 1);
+    const unsigned helpers = budget.try_acquire(static_cast<unsigned>(std::min<size_t>(max_chunks - 1, 1024)));
+
+    struct BudgetGuard
+    {
+        ThreadBudget& budget;
+        unsigned count;
+
+        ~BudgetGuard()
+        {
+            budget.release(count);
+        }
+    } guard{budget, helpers};
+
+    const size_t no_of_chunks = helpers + 1;
+    std::vector<TResult> results(no_of_chunks);
+
+    auto first = [=](size_t chunk) { return size * chunk / no_of_chunks; };
+
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(helpers);
+    for (size_t chunk = 1; chunk < no_of_chunks; ++chunk)
+        tasks.push_back(std::async(std::launch::async, [&, chunk] { f(first(chunk), first(chunk + 1), results[chunk]); }));
+
+    f(first(0), first(1), results[0]);
+
+    for (auto& task : tasks)
+        task.get();
+
+    return results;
+}
+
+#endif /*THREAD_BUDGET_HPP_*/
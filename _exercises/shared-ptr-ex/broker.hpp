@@ -0,0 +1,181 @@
+#ifndef BROKER_HPP
+#define BROKER_HPP
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "observer.hpp"
+
+// Publish/subscribe broker for many topics
+// - subscriptions are indexed by exact topic (hash map) and by topic prefix (trie),
+//   so publish visits only observers interested in the published topic
+// - observers are held by weak_ptr - exactly like in Subject - dead ones are removed lazily
+// - subscriptions of a topic or prefix are keyed by owner of the observer - (un)subscribe costs O(log n)
+// - trie nodes left without subscriptions are pruned by unsubscribe_prefix()
+// - observers must not (un)subscribe from inside update()
+class TopicBroker
+{
+public:
+    using Predicate = std::function<bool(std::string_view topic, const std::string& event_args)>;
+
+private:
+    using Subscriptions = std::map<std::weak_ptr<Observer>, Predicate, std::owner_less<std::weak_ptr<Observer>>>;
+
+    struct TrieNode
+    {
+        std::vector<std::pair<char, std::unique_ptr<TrieNode>>> children; // sorted by char
+        Subscriptions subscriptions;
+
+        TrieNode* find_child(char c) const
+        {
+            auto pos = std::lower_bound(children.begin(), children.end(), c,
+                [](const auto& child, char key) { return child.first < key; });
+            return (pos != children.end() && pos->first == c) ? pos->second.get() : nullptr;
+        }
+
+        bool empty() const
+        {
+            return children.empty() && subscriptions.empty();
+        }
+
+        void erase_child(char c)
+        {
+            std::erase_if(children, [c](const auto& child) { return child.first == c; });
+        }
+
+        TrieNode& get_child(char c)
+        {
+            auto pos = std::lower_bound(children.begin(), children.end(), c,
+                [](const auto& child, char key) { return child.first < key; });
+            if (pos == children.end() || pos->first != c)
+                pos = children.emplace(pos, c, std::make_unique<TrieNode>());
+            return *pos->second;
+        }
+    };
+
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view txt) const
+        {
+            return std::hash<std::string_view>{}(txt);
+        }
+    };
+
+    std::unordered_map<std::string, Subscriptions, StringHash, std::equal_to<>> topics_;
+    TrieNode prefixes_;
+
+public:
+    void subscribe(std::string_view topic, std::weak_ptr<Observer> observer, Predicate filter = {})
+    {
+        auto pos = topics_.find(topic);
+        if (pos == topics_.end())
+            pos = topics_.emplace(std::string(topic), Subscriptions{}).first;
+
+        pos->second.insert_or_assign(std::move(observer), std::move(filter));
+    }
+
+    void unsubscribe(std::string_view topic, const std::weak_ptr<Observer>& observer)
+    {
+        if (auto pos = topics_.find(topic); pos != topics_.end())
+        {
+            pos->second.erase(observer);
+            if (pos->second.empty())
+                topics_.erase(pos);
+        }
+    }
+
+    // observer is notified about every topic starting with prefix (empty prefix - all topics)
+    void subscribe_prefix(std::string_view prefix, std::weak_ptr<Observer> observer, Predicate filter = {})
+    {
+        TrieNode* node = &prefixes_;
+        for (char c : prefix)
+            node = &node->get_child(c);
+
+        node->subscriptions.insert_or_assign(std::move(observer), std::move(filter));
+    }
+
+    void unsubscribe_prefix(std::string_view prefix, const std::weak_ptr<Observer>& observer)
+    {
+        std::vector<TrieNode*> path{&prefixes_}; // path[i] is the node of prefix[0, i)
+        path.reserve(prefix.size() + 1);
+        for (char c : prefix)
+        {
+            TrieNode* child = path.back()->find_child(c);
+            if (!child)
+                return;
+            path.push_back(child);
+        }
+
+        path.back()->subscriptions.erase(observer);
+
+        // nodes without subscriptions in their subtree are removed bottom-up
+        for (size_t i = prefix.size(); i > 0 && path[i]->empty(); --i)
+            path[i - 1]->erase_child(prefix[i - 1]);
+    }
+
+    bool empty() const
+    {
+        return topics_.empty() && prefixes_.empty();
+    }
+
+    // returns number of notified observers
+    size_t publish(std::string_view topic, const std::string& event_args)
+    {
+        size_t notified = 0;
+
+        if (auto pos = topics_.find(topic); pos != topics_.end())
+        {
+            notified += notify(pos->second, topic, event_args);
+            if (pos->second.empty())
+                topics_.erase(pos);
+        }
+
+        TrieNode* node = &prefixes_;
+        for (size_t i = 0;; ++i)
+        {
+            notified += notify(node->subscriptions, topic, event_args);
+
+            if (i == topic.size() || (node = node->find_child(topic[i])) == nullptr)
+                break;
+        }
+
+        return notified;
+    }
+
+private:
+    static size_t notify(Subscriptions& subscriptions, std::string_view topic, const std::string& event_args)
+    {
+        size_t notified = 0;
+        bool has_dead_observers = false;
+
+        for (const auto& [observer, filter] : subscriptions)
+        {
+            if (std::shared_ptr obs = observer.lock())
+            {
+                if (!filter || filter(topic, event_args))
+                {
+                    obs->update(event_args);
+                    ++notified;
+                }
+            }
+            else
+                has_dead_observers = true;
+        }
+
+        if (has_dead_observers)
+            std::erase_if(subscriptions, [](const auto& subscription) { return subscription.first.expired(); });
+
+        return notified;
+    }
+};
+
+#endif // BROKER_HPP
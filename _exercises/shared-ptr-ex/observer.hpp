@@ -0,0 +1,536 @@
+#ifndef OBSERVER_HPP
+#define OBSERVER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "seqlock.hpp"
+#include "state_history.hpp"
+
+class Observer
+{
+public:
+    virtual void update(const std::string& event_args) = 0;
+    virtual ~Observer() = default;
+};
+
+// event_args of notifications sent by Subject::set_state()
+inline std::string state_changed_event(int state)
+{
+    return "Changed state on: " + std::to_string(state);
+}
+
+// state carried by event_args of a state change notification
+inline std::optional<int> state_of_event(std::string_view event_args)
+{
+    constexpr std::string_view prefix = "Changed state on: ";
+    if (!event_args.starts_with(prefix))
+        return std::nullopt;
+
+    int state = 0;
+    const char* last = event_args.data() + event_args.size();
+    auto [end, error] = std::from_chars(event_args.data() + prefix.size(), last, state);
+    if (error != std::errc{} || end != last)
+        return std::nullopt;
+    return state;
+}
+
+// Executor decides where coroutines waiting for a state change are resumed
+class Executor
+{
+public:
+    virtual void execute(std::coroutine_handle<> handle) = 0;
+    virtual ~Executor() = default;
+};
+
+// resumes waiters on the notifier's thread - inside set_state()
+class InlineExecutor : public Executor
+{
+public:
+    void execute(std::coroutine_handle<> handle) override
+    {
+        handle.resume();
+    }
+
+    static InlineExecutor& instance()
+    {
+        static InlineExecutor executor;
+        return executor;
+    }
+};
+
+class StateWaiters;
+
+// Awaiter returned by Subject::next_state()
+// - it lives in the frame of the awaiting coroutine and is linked into the subject's list of waiters,
+//   so a suspended waiter does not allocate
+// - the awaiting coroutine must not be destroyed while suspended
+// - when the subject is destroyed, suspended waiters are resumed and co_await throws std::runtime_error
+class StateAwaiter
+{
+    StateWaiters& waiters_;
+    Executor& executor_;
+    std::coroutine_handle<> handle_;
+    StateAwaiter* next_ = nullptr;
+    int state_ = 0;
+    bool cancelled_ = false;
+
+    friend class StateWaiters;
+
+public:
+    StateAwaiter(StateWaiters& waiters, Executor& executor)
+        : waiters_{waiters}
+        , executor_{executor}
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    int await_resume() const
+    {
+        if (cancelled_)
+            throw std::runtime_error("Subject destroyed while waiting for the next state");
+        return state_;
+    }
+};
+
+// intrusive FIFO list of suspended StateAwaiters
+// - waiters may be enqueued concurrently (e.g. by coroutines resumed on other executors)
+// - moved waiters are appended to the target list, waiters left at destruction are cancelled
+class StateWaiters
+{
+    std::mutex mtx_;
+    StateAwaiter* head_ = nullptr;
+    StateAwaiter* tail_ = nullptr;
+
+public:
+    StateWaiters() = default;
+
+    StateWaiters(const StateWaiters&) = delete;
+    StateWaiters& operator=(const StateWaiters&) = delete;
+
+    StateWaiters(StateWaiters&& other)
+    {
+        splice(other);
+    }
+
+    StateWaiters& operator=(StateWaiters&& other)
+    {
+        if (this != &other)
+            splice(other);
+        return *this;
+    }
+
+    ~StateWaiters()
+    {
+        StateAwaiter* waiter = head_;
+        while (waiter)
+        {
+            StateAwaiter* next = waiter->next_;
+            waiter->cancelled_ = true;
+            waiter->executor_.execute(waiter->handle_);
+            waiter = next;
+        }
+    }
+
+    void enqueue(StateAwaiter* waiter)
+    {
+        std::lock_guard lk{mtx_};
+
+        if (tail_)
+            tail_->next_ = waiter;
+        else
+            head_ = waiter;
+        tail_ = waiter;
+    }
+
+    void resume_all(int state)
+    {
+        StateAwaiter* waiter = nullptr;
+        {
+            std::lock_guard lk{mtx_};
+            waiter = std::exchange(head_, nullptr);
+            tail_ = nullptr;
+        }
+
+        while (waiter)
+        {
+            StateAwaiter* next = waiter->next_; // waiter is destroyed when its coroutine resumes
+            waiter->state_ = state;
+            waiter->executor_.execute(waiter->handle_);
+            waiter = next;
+        }
+    }
+
+private:
+    // moves waiters of other to the end of this list
+    void splice(StateWaiters& other)
+    {
+        std::scoped_lock lk{mtx_, other.mtx_};
+
+        if (other.head_ == nullptr)
+            return;
+
+        if (tail_)
+            tail_->next_ = other.head_;
+        else
+            head_ = other.head_;
+        tail_ = other.tail_;
+        other.head_ = other.tail_ = nullptr;
+    }
+};
+
+inline void StateAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+    waiters_.enqueue(this);
+}
+
+// Async generator of states returned by Subject::states()
+// - changes are buffered, so a consumer resumed on another executor does not miss changes
+//   made before it awaits again: for (;;) { int state = co_await stream.next(); }
+// - when the buffer is full the oldest state is dropped and counted in dropped()
+// - when the subject is destroyed, buffered states are still returned, then next() throws std::runtime_error
+// - one consumer per stream; the subject may push states from another thread
+class StateStream
+{
+public:
+    class Channel
+    {
+        std::mutex mtx_;
+        std::deque<int> buffer_;
+        size_t capacity_;
+        uint64_t dropped_ = 0;
+        std::coroutine_handle<> waiting_;
+        Executor* executor_ = nullptr;
+        bool closed_ = false;
+
+        friend class StateStream;
+
+    public:
+        explicit Channel(size_t capacity)
+            : capacity_{std::max<size_t>(capacity, 1)}
+        {
+        }
+
+        void push(int state)
+        {
+            std::unique_lock lk{mtx_};
+            if (buffer_.size() == capacity_)
+            {
+                buffer_.pop_front();
+                ++dropped_;
+            }
+            buffer_.push_back(state);
+            wake(lk);
+        }
+
+        void close()
+        {
+            std::unique_lock lk{mtx_};
+            closed_ = true;
+            wake(lk);
+        }
+
+    private:
+        void wake(std::unique_lock<std::mutex>& lk)
+        {
+            if (!waiting_)
+                return;
+
+            auto handle = std::exchange(waiting_, nullptr);
+            Executor* executor = executor_;
+            lk.unlock();
+            executor->execute(handle);
+        }
+    };
+
+    class NextAwaiter
+    {
+        Channel& channel_;
+        Executor& executor_;
+
+    public:
+        NextAwaiter(Channel& channel, Executor& executor)
+            : channel_{channel}
+            , executor_{executor}
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        // does not suspend when a state is buffered or the subject is gone
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard lk{channel_.mtx_};
+            if (!channel_.buffer_.empty() || channel_.closed_)
+                return false;
+            channel_.waiting_ = handle;
+            channel_.executor_ = &executor_;
+            return true;
+        }
+
+        int await_resume()
+        {
+            std::lock_guard lk{channel_.mtx_};
+            if (channel_.buffer_.empty())
+                throw std::runtime_error("Subject destroyed while waiting for the next state");
+            const int state = channel_.buffer_.front();
+            channel_.buffer_.pop_front();
+            return state;
+        }
+    };
+
+    StateStream(std::shared_ptr<Channel> channel, Executor& executor)
+        : channel_{std::move(channel)}
+        , executor_{&executor}
+    {
+    }
+
+    // co_await stream.next() - returns the oldest buffered state or suspends until the next change
+    [[nodiscard]] NextAwaiter next()
+    {
+        return NextAwaiter{*channel_, *executor_};
+    }
+
+    // number of states dropped because the buffer was full - consumers may detect a gap by checking it
+    uint64_t dropped() const
+    {
+        std::lock_guard lk{channel_->mtx_};
+        return channel_->dropped_;
+    }
+
+private:
+    std::shared_ptr<Channel> channel_;
+    Executor* executor_;
+};
+
+// channels of the subject's streams - dead streams are removed when states are pushed
+// - moved channels are appended to the target list, channels left at destruction are closed
+class StateStreams
+{
+    std::vector<std::weak_ptr<StateStream::Channel>> channels_;
+
+public:
+    StateStreams() = default;
+
+    StateStreams(const StateStreams&) = delete;
+    StateStreams& operator=(const StateStreams&) = delete;
+
+    StateStreams(StateStreams&& other)
+        : channels_{std::exchange(other.channels_, {})}
+    {
+    }
+
+    StateStreams& operator=(StateStreams&& other)
+    {
+        if (this != &other)
+            for (auto& channel : std::exchange(other.channels_, {}))
+                channels_.push_back(std::move(channel));
+        return *this;
+    }
+
+    ~StateStreams()
+    {
+        for (const auto& channel : channels_)
+            if (auto ch = channel.lock())
+                ch->close();
+    }
+
+    void add(std::weak_ptr<StateStream::Channel> channel)
+    {
+        channels_.push_back(std::move(channel));
+    }
+
+    void push(int state)
+    {
+        std::erase_if(channels_, [state](const auto& channel) {
+            auto ch = channel.lock();
+            if (!ch)
+                return true;
+            ch->push(state);
+            return false;
+        });
+    }
+};
+
+// default storage of Subject's state - plain value, no synchronization
+template <typename T>
+class PlainValue
+{
+    T value_{};
+
+public:
+    PlainValue(const T& value = T{})
+        : value_{value}
+    {
+    }
+
+    T load() const
+    {
+        return value_;
+    }
+
+    void store(const T& value)
+    {
+        value_ = value;
+    }
+};
+
+// StateStorage - PlainValue<int> or Seqlocked<int> when state() is read from many threads
+// - set_state(), observer registration, copy & move must be called from a single thread;
+//   with PlainValue state() must be read from that thread too
+// - copy gets the state, observers and history but no waiters or streams, move takes them along
+template <typename StateStorage = PlainValue<int>>
+class BasicSubject
+{
+    StateStorage state_;
+    std::set<std::weak_ptr<Observer>, std::owner_less<std::weak_ptr<Observer>>> observers_;
+    StateWaiters waiters_;
+    StateStreams streams_;
+    std::unique_ptr<StateHistory> history_;
+
+public:
+    BasicSubject() = default;
+
+    BasicSubject(const BasicSubject& other)
+        : state_{other.state()}
+        , observers_{other.observers_}
+        , history_{other.history_ ? std::make_unique<StateHistory>(*other.history_) : nullptr}
+    {
+    }
+
+    BasicSubject(BasicSubject&& other)
+        : state_{other.state()}
+        , observers_{std::move(other.observers_)}
+        , waiters_{std::move(other.waiters_)}
+        , streams_{std::move(other.streams_)}
+        , history_{std::move(other.history_)}
+    {
+    }
+
+    BasicSubject& operator=(const BasicSubject& other)
+    {
+        if (this != &other)
+        {
+            state_.store(other.state());
+            observers_ = other.observers_;
+            history_ = other.history_ ? std::make_unique<StateHistory>(*other.history_) : nullptr;
+        }
+        return *this;
+    }
+
+    BasicSubject& operator=(BasicSubject&& other)
+    {
+        if (this != &other)
+        {
+            state_.store(other.state());
+            observers_ = std::move(other.observers_);
+            waiters_ = std::move(other.waiters_);
+            streams_ = std::move(other.streams_);
+            history_ = std::move(other.history_);
+        }
+        return *this;
+    }
+
+    void register_observer(std::weak_ptr<Observer> observer)
+    {
+        observers_.insert(observer);
+    }
+
+    void unregister_observer(std::weak_ptr<Observer> observer)
+    {
+        observers_.erase(observer);
+    }
+
+    int state() const
+    {
+        return state_.load();
+    }
+
+    void set_state(int new_state)
+    {
+        if (state_.load() != new_state)
+        {
+            state_.store(new_state);
+            if (history_)
+                history_->append(StateHistory::Clock::now(), new_state);
+            notify(state_changed_event(new_state));
+            streams_.push(new_state);
+            waiters_.resume_all(new_state);
+        }
+    }
+
+    // optional - records at most max_entries last changes of state
+    void enable_history(size_t max_entries)
+    {
+        history_ = std::make_unique<StateHistory>(max_entries);
+    }
+
+    const StateHistory* history() const
+    {
+        return history_.get();
+    }
+
+    // co_await subject.next_state() - suspends until the next change of state and returns the new state
+    // - changes made before the waiter awaits again are missed - use states() to get all of them
+    [[nodiscard]] StateAwaiter next_state(Executor& executor = InlineExecutor::instance())
+    {
+        return StateAwaiter{waiters_, executor};
+    }
+
+    // stream of all following changes of state - at most capacity of them are buffered
+    [[nodiscard]] StateStream states(size_t capacity = 64, Executor& executor = InlineExecutor::instance())
+    {
+        auto channel = std::make_shared<StateStream::Channel>(capacity);
+        streams_.add(channel);
+        return StateStream{std::move(channel), executor};
+    }
+
+protected:
+    void notify(const std::string& event_args)
+    {
+        for(auto it = observers_.begin(); it != observers_.end(); )
+        {
+            if(std::shared_ptr obs = it->lock())
+            {
+                obs->update(event_args);
+                ++it;
+            }
+            else
+            {
+                std::cout << "Removing dead object!\n";
+                it = observers_.erase(it);
+            }
+        }
+    }
+};
+
+using Subject = BasicSubject<>;
+
+// state() may be read concurrently with set_state()
+using ConcurrentSubject = BasicSubject<Seqlocked<int>>;
+
+#endif // OBSERVER_HPP
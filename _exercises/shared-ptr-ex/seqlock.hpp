@@ -0,0 +1,105 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Concurrency
+{
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+// Sequence lock for frequently read, rarely written trivially copyable values
+// - readers never block writers: they copy the value and retry when a write overlapped the copy
+// - writers are serialized by the odd (locked) sequence number
+// - payload is kept in atomic words, so concurrent reads and writes are not a data race
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class Seqlocked
+{
+    using Word = uint64_t;
+    static constexpr size_t word_count = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+    alignas(64) std::atomic<uint64_t> seq_{0};
+    std::array<std::atomic<Word>, word_count> words_;
+
+public:
+    Seqlocked(const T& value = T{})
+    {
+        std::array<Word, word_count> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+        for (size_t i = 0; i < word_count; ++i)
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    Seqlocked(const Seqlocked&) = delete;
+    Seqlocked& operator=(const Seqlocked&) = delete;
+
+    T load() const
+    {
+        std::array<Word, word_count> buffer;
+
+        for (;;)
+        {
+            const uint64_t seq_before = seq_.load(std::memory_order_acquire);
+            if (seq_before & 1)
+            {
+                Concurrency::cpu_relax();
+                continue;
+            }
+
+            for (size_t i = 0; i < word_count; ++i)
+                buffer[i] = words_[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == seq_before)
+                break;
+        }
+
+        T value;
+        std::memcpy(&value, buffer.data(), sizeof(T));
+        return value;
+    }
+
+    void store(const T& value)
+    {
+        std::array<Word, word_count> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        while ((seq & 1) || !seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            Concurrency::cpu_relax();
+            seq = seq_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < word_count; ++i)
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // number of completed writes
+    uint64_t version() const
+    {
+        return seq_.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif // SEQLOCK_HPP
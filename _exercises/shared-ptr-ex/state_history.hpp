@@ -0,0 +1,251 @@
+#ifndef STATE_HISTORY_HPP
+#define STATE_HISTORY_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Bounded history of state changes stored in compressed blocks (Gorilla-like)
+// - timestamps are encoded as zig-zag varint delta-of-delta, states as zig-zag varint delta,
+//   so a regular stream of changes costs a few bytes per entry
+// - range queries find the first block with binary search and decode only the blocks in range
+// - the oldest entry is dropped when the history exceeds max_entries, the memory of a block
+//   is released when all its entries are dropped
+class StateHistory
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct Entry
+    {
+        TimePoint timestamp;
+        int state;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    // position of an entry in the whole (unbounded) sequence of appended entries
+    struct Cursor
+    {
+        uint64_t position = 0;
+
+        auto operator<=>(const Cursor&) const = default;
+    };
+
+private:
+    struct Block
+    {
+        uint64_t first_position;
+        int64_t first_timestamp;
+        int64_t last_timestamp;
+        int64_t last_delta;
+        int first_state;
+        int last_state;
+        uint32_t count = 1;
+        std::vector<uint8_t> bytes; // entries after the first one
+    };
+
+    class BlockDecoder
+    {
+        const Block& block_;
+        size_t offset_ = 0;
+        uint32_t index_ = 0;
+        int64_t timestamp_;
+        int64_t delta_ = 0;
+        int state_;
+
+    public:
+        explicit BlockDecoder(const Block& block)
+            : block_{block}
+            , timestamp_{block.first_timestamp}
+            , state_{block.first_state}
+        {
+        }
+
+        bool done() const
+        {
+            return index_ == block_.count;
+        }
+
+        Entry current() const
+        {
+            return Entry{TimePoint{Clock::duration{timestamp_}}, state_};
+        }
+
+        void next()
+        {
+            if (++index_ == block_.count)
+                return;
+
+            delta_ += zigzag_decode(read_varint(block_.bytes, offset_));
+            timestamp_ += delta_;
+            state_ = static_cast<int>(state_ + zigzag_decode(read_varint(block_.bytes, offset_)));
+        }
+    };
+
+    size_t max_entries_;
+    size_t entries_per_block_;
+    size_t size_ = 0;
+    uint64_t first_position_ = 0; // oldest entry kept in history
+    uint64_t next_position_ = 0;
+    std::deque<Block> blocks_;
+
+public:
+    explicit StateHistory(size_t max_entries, size_t entries_per_block = 256)
+        : max_entries_{std::max<size_t>(max_entries, 1)}
+        , entries_per_block_{std::clamp<size_t>(entries_per_block, 1, max_entries_)}
+    {
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    // timestamps must not decrease
+    void append(TimePoint timestamp, int state)
+    {
+        const int64_t ts = timestamp.time_since_epoch().count();
+
+        if (blocks_.empty() || blocks_.back().count == entries_per_block_)
+        {
+            blocks_.push_back(Block{next_position_, ts, ts, 0, state, state, 1, {}});
+        }
+        else
+        {
+            Block& block = blocks_.back();
+            assert(ts >= block.last_timestamp);
+
+            const int64_t delta = ts - block.last_timestamp;
+            write_varint(block.bytes, zigzag_encode(delta - block.last_delta));
+            write_varint(block.bytes, zigzag_encode(int64_t{state} - block.last_state));
+
+            block.last_delta = delta;
+            block.last_timestamp = ts;
+            block.last_state = state;
+            ++block.count;
+        }
+
+        ++next_position_;
+        ++size_;
+
+        if (size_ > max_entries_)
+        {
+            --size_;
+            ++first_position_;
+            if (blocks_.front().first_position + blocks_.front().count == first_position_)
+                blocks_.pop_front();
+        }
+    }
+
+    Cursor begin() const
+    {
+        return Cursor{first_position_};
+    }
+
+    Cursor end() const
+    {
+        return Cursor{next_position_};
+    }
+
+    // entries with from <= timestamp < to
+    std::vector<Entry> range(TimePoint from, TimePoint to) const
+    {
+        std::vector<Entry> result;
+
+        const int64_t ts_from = from.time_since_epoch().count();
+        const int64_t ts_to = to.time_since_epoch().count();
+
+        auto block = std::partition_point(blocks_.begin(), blocks_.end(), [ts_from](const Block& b) { return b.last_timestamp < ts_from; });
+
+        for (; block != blocks_.end() && block->first_timestamp < ts_to; ++block)
+        {
+            uint64_t position = block->first_position;
+            for (BlockDecoder decoder{*block}; !decoder.done(); decoder.next(), ++position)
+            {
+                Entry entry = decoder.current();
+                if (entry.timestamp >= to)
+                    break;
+                if (entry.timestamp >= from && position >= first_position_)
+                    result.push_back(entry);
+            }
+        }
+
+        return result;
+    }
+
+    // calls f(const Entry&) for entries from cursor to the end of history, returns cursor past the last replayed entry
+    // - entries that already dropped out of history are skipped
+    template <typename F>
+    Cursor replay(Cursor from, F&& f) const
+    {
+        from = std::max(from, begin());
+
+        auto block = std::partition_point(blocks_.begin(), blocks_.end(),
+            [&from](const Block& b) { return b.first_position + b.count <= from.position; });
+
+        for (; block != blocks_.end(); ++block)
+        {
+            uint64_t position = block->first_position;
+            for (BlockDecoder decoder{*block}; !decoder.done(); decoder.next(), ++position)
+            {
+                if (position >= from.position)
+                    f(decoder.current());
+            }
+        }
+
+        return end();
+    }
+
+    size_t memory_usage() const
+    {
+        size_t bytes = sizeof(*this);
+        for (const auto& block : blocks_)
+            bytes += sizeof(Block) + block.bytes.capacity();
+        return bytes;
+    }
+
+private:
+    static uint64_t zigzag_encode(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t zigzag_decode(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    static void write_varint(std::vector<uint8_t>& bytes, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint64_t read_varint(const std::vector<uint8_t>& bytes, size_t& offset)
+    {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            const uint8_t byte = bytes[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+    }
+};
+
+#endif // STATE_HISTORY_HPP
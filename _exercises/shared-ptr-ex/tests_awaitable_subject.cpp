@@ -0,0 +1,265 @@
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "observer.hpp"
+
+namespace
+{
+    // fire & forget coroutine - frame is destroyed when the body finishes
+    struct Detached
+    {
+        struct promise_type
+        {
+            Detached get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept { }
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // queues resumptions - they run when the owner calls run()
+    class QueueExecutor : public Executor
+    {
+        std::deque<std::coroutine_handle<>> queue_;
+
+    public:
+        void execute(std::coroutine_handle<> handle) override
+        {
+            queue_.push_back(handle);
+        }
+
+        size_t run()
+        {
+            size_t count = 0;
+            while (!queue_.empty())
+            {
+                auto handle = queue_.front();
+                queue_.pop_front();
+                handle.resume();
+                ++count;
+            }
+            return count;
+        }
+    };
+
+    Detached wait_for_state(Subject& subject, std::vector<int>& states, int count, Executor& executor = InlineExecutor::instance())
+    {
+        for (int i = 0; i < count; ++i)
+            states.push_back(co_await subject.next_state(executor));
+    }
+
+    Detached count_changes(Subject& subject, int& counter)
+    {
+        co_await subject.next_state();
+        ++counter;
+    }
+
+    Detached read_states(StateStream stream, std::vector<int>& states, bool& closed)
+    {
+        try
+        {
+            for (;;)
+                states.push_back(co_await stream.next());
+        }
+        catch (const std::runtime_error&)
+        {
+            closed = true;
+        }
+    }
+
+    Detached wait_until_destroyed(Subject& subject, bool& cancelled)
+    {
+        try
+        {
+            co_await subject.next_state();
+        }
+        catch (const std::runtime_error&)
+        {
+            cancelled = true;
+        }
+    }
+}
+
+TEST_CASE("co_await subject.next_state()")
+{
+    Subject s;
+    std::vector<int> states;
+
+    SECTION("resumed inline by set_state")
+    {
+        wait_for_state(s, states, 2);
+        REQUIRE(states.empty());
+
+        s.set_state(1);
+        s.set_state(1); // no change
+        s.set_state(2);
+        s.set_state(3);
+
+        REQUIRE(states == std::vector{1, 2});
+    }
+
+    SECTION("resumed on chosen executor")
+    {
+        QueueExecutor executor;
+        wait_for_state(s, states, 3, executor);
+
+        s.set_state(1);
+        REQUIRE(states.empty());
+
+        REQUIRE(executor.run() == 1);
+        REQUIRE(states == std::vector{1});
+
+        s.set_state(2);
+        s.set_state(3); // waiter not yet re-suspended - change is missed
+        executor.run();
+        s.set_state(4);
+        executor.run();
+
+        REQUIRE(states == std::vector{1, 2, 4});
+    }
+
+    SECTION("many lightweight waiters")
+    {
+        constexpr int no_of_waiters = 200'000;
+
+        int counter = 0;
+        for (int i = 0; i < no_of_waiters; ++i)
+            count_changes(s, counter);
+
+        s.set_state(42);
+
+        REQUIRE(counter == no_of_waiters);
+    }
+}
+
+TEST_CASE("Subject::states() - buffered stream of states")
+{
+    std::vector<int> states;
+    bool closed = false;
+
+    SECTION("consumer resumed on chosen executor gets all changes")
+    {
+        QueueExecutor executor;
+        {
+            Subject s;
+            read_states(s.states(64, executor), states, closed);
+
+            s.set_state(1);
+            REQUIRE(states.empty());
+            executor.run();
+            REQUIRE(states == std::vector{1});
+
+            s.set_state(2);
+            s.set_state(3); // buffered while the consumer is queued
+            executor.run();
+            s.set_state(4);
+            executor.run();
+
+            REQUIRE(states == std::vector{1, 2, 3, 4});
+            REQUIRE_FALSE(closed);
+        }
+
+        executor.run();
+        REQUIRE(closed);
+    }
+
+    SECTION("full buffer drops oldest states")
+    {
+        Subject s;
+        StateStream stream = s.states(2);
+        for (int i = 1; i <= 5; ++i)
+            s.set_state(i);
+
+        REQUIRE(stream.dropped() == 3);
+
+        auto read = [](StateStream& stream, std::vector<int>& states) -> Detached {
+            states.push_back(co_await stream.next());
+            states.push_back(co_await stream.next());
+        };
+        read(stream, states);
+
+        REQUIRE(states == std::vector{4, 5});
+    }
+
+    SECTION("buffered states are returned after the subject is destroyed")
+    {
+        std::optional<Subject> s{std::in_place};
+        StateStream stream = s->states();
+        s->set_state(1);
+        s.reset();
+
+        read_states(std::move(stream), states, closed);
+
+        REQUIRE(states == std::vector{1});
+        REQUIRE(closed);
+    }
+
+    SECTION("streams are moved with the subject, dead streams are removed")
+    {
+        Subject s;
+        {
+            StateStream discarded = s.states();
+        }
+        read_states(s.states(), states, closed);
+
+        Subject target = std::move(s);
+        target.set_state(7);
+
+        REQUIRE(states == std::vector{7});
+    }
+}
+
+TEST_CASE("Subject - copy & move")
+{
+    static_assert(std::is_copy_constructible_v<Subject> && std::is_move_constructible_v<Subject>);
+    static_assert(std::is_copy_assignable_v<ConcurrentSubject> && std::is_move_assignable_v<ConcurrentSubject>);
+
+    Subject s;
+    s.enable_history(10);
+    s.set_state(1);
+    std::vector<int> states;
+    wait_for_state(s, states, 1);
+
+    SECTION("copy has no waiters")
+    {
+        Subject copy = s;
+        copy.set_state(2);
+
+        REQUIRE(copy.state() == 2);
+        REQUIRE(copy.history()->size() == 2);
+        REQUIRE(s.history()->size() == 1);
+        REQUIRE(states.empty());
+
+        s.set_state(2);
+        REQUIRE(states == std::vector{2});
+    }
+
+    SECTION("waiters are moved")
+    {
+        Subject target;
+        target = std::move(s);
+        target.set_state(3);
+
+        REQUIRE(states == std::vector{3});
+    }
+}
+
+TEST_CASE("Subject - destroyed with suspended waiters")
+{
+    bool cancelled = false;
+    {
+        Subject s;
+        wait_until_destroyed(s, cancelled);
+        REQUIRE_FALSE(cancelled);
+    }
+
+    REQUIRE(cancelled);
+}
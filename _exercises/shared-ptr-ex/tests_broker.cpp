@@ -0,0 +1,147 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "broker.hpp"
+
+namespace
+{
+    struct CountingObserver : Observer
+    {
+        std::vector<std::string> events;
+
+        void update(const std::string& event_args) override
+        {
+            events.push_back(event_args);
+        }
+    };
+
+    struct NullObserver : Observer
+    {
+        size_t counter = 0;
+
+        void update(const std::string&) override
+        {
+            ++counter;
+        }
+    };
+}
+
+TEST_CASE("TopicBroker")
+{
+    TopicBroker broker;
+    auto temp = std::make_shared<CountingObserver>();
+    auto sensors = std::make_shared<CountingObserver>();
+    auto all = std::make_shared<CountingObserver>();
+
+    broker.subscribe("sensor/1/temp", temp);
+    broker.subscribe_prefix("sensor/", sensors);
+    broker.subscribe_prefix("", all);
+
+    SECTION("exact topic")
+    {
+        REQUIRE(broker.publish("sensor/1/temp", "21") == 3);
+        REQUIRE(temp->events == std::vector<std::string>{"21"});
+    }
+
+    SECTION("prefix")
+    {
+        REQUIRE(broker.publish("sensor/2/temp", "22") == 2);
+        REQUIRE(temp->events.empty());
+        REQUIRE(sensors->events == std::vector<std::string>{"22"});
+
+        REQUIRE(broker.publish("actuator/1", "on") == 1);
+        REQUIRE(all->events == std::vector<std::string>{"22", "on"});
+    }
+
+    SECTION("predicate")
+    {
+        auto hot = std::make_shared<CountingObserver>();
+        broker.subscribe_prefix("sensor/", hot, [](std::string_view, const std::string& event_args) { return std::stoi(event_args) > 30; });
+
+        broker.publish("sensor/1/temp", "21");
+        broker.publish("sensor/3/temp", "35");
+
+        REQUIRE(hot->events == std::vector<std::string>{"35"});
+    }
+
+    SECTION("unsubscribe")
+    {
+        broker.unsubscribe("sensor/1/temp", temp);
+        broker.unsubscribe_prefix("sensor/", sensors);
+
+        REQUIRE(broker.publish("sensor/1/temp", "21") == 1);
+        REQUIRE(temp->events.empty());
+        REQUIRE(sensors->events.empty());
+    }
+
+    SECTION("subscribing again replaces the filter")
+    {
+        broker.subscribe_prefix("sensor/", sensors, [](std::string_view topic, const std::string&) { return topic.ends_with("/hum"); });
+
+        REQUIRE(broker.publish("sensor/2/temp", "22") == 1);
+        REQUIRE(broker.publish("sensor/2/hum", "60") == 2);
+        REQUIRE(sensors->events == std::vector<std::string>{"60"});
+    }
+
+    SECTION("unsubscribe prunes empty prefix nodes")
+    {
+        broker.subscribe_prefix("sensor/1/", sensors);
+
+        broker.unsubscribe_prefix("sensor/", sensors);
+        REQUIRE(broker.publish("sensor/1/hum", "60") == 2);
+
+        broker.unsubscribe_prefix("sensor/1/", sensors);
+        broker.unsubscribe_prefix("", all);
+        broker.unsubscribe("sensor/1/temp", temp);
+        REQUIRE(broker.empty());
+    }
+
+    SECTION("dead observers are not notified")
+    {
+        temp.reset();
+        sensors.reset();
+
+        REQUIRE(broker.publish("sensor/1/temp", "21") == 1);
+    }
+}
+
+TEST_CASE("TopicBroker - publish cost vs. selectivity", "[.benchmark]")
+{
+    constexpr int no_of_topics = 1'000;
+    constexpr int no_of_observers = 10'000;
+
+    std::vector<std::shared_ptr<NullObserver>> observers;
+    for (int i = 0; i < no_of_observers; ++i)
+        observers.push_back(std::make_shared<NullObserver>());
+
+    Subject subject;
+    for (const auto& o : observers)
+        subject.register_observer(o);
+
+    BENCHMARK("Subject::set_state - all observers")
+    {
+        static int state = 0;
+        subject.set_state(++state);
+        return observers.front()->counter;
+    };
+
+    for (int topics_per_observer : {1, 10, 100})
+    {
+        TopicBroker broker;
+        for (int i = 0; i < no_of_observers; ++i)
+            for (int t = 0; t < topics_per_observer; ++t)
+                broker.subscribe("topic/" + std::to_string((i + t * 7) % no_of_topics), observers[i]);
+
+        const std::string topic = "topic/" + std::to_string(no_of_topics / 2);
+
+        const int interested = topics_per_observer * no_of_observers / no_of_topics;
+
+        BENCHMARK("TopicBroker::publish - " + std::to_string(interested) + " of " + std::to_string(no_of_observers) + " observers interested")
+        {
+            return broker.publish(topic, "Changed state");
+        };
+    }
+}
@@ -7,60 +7,7 @@
 #include <memory>
 #include <catch2/catch_test_macros.hpp>
 
-class Observer
-{
-public:
-    virtual void update(const std::string& event_args) = 0;
-    virtual ~Observer() = default;
-};
-
-class Subject
-{
-    int state_;
-    std::set<std::weak_ptr<Observer>, std::owner_less<std::weak_ptr<Observer>>> observers_;
-
-public:
-    Subject() : state_(0)
-    {
-    }
-
-    void register_observer(std::weak_ptr<Observer> observer)
-    {
-        observers_.insert(observer);
-    }
-
-    void unregister_observer(std::weak_ptr<Observer> observer)
-    {
-        observers_.erase(observer);
-    }
-
-    void set_state(int new_state)
-    {
-        if (state_ != new_state)
-        {
-            state_ = new_state;
-            notify("Changed state on: " + std::to_string(state_));
-        }
-    }
-
-protected:
-    void notify(const std::string& event_args)
-    {
-        for(auto it = observers_.begin(); it != observers_.end(); )
-        {
-            if(std::shared_ptr obs = it->lock())
-            {
-                obs->update(event_args);
-                ++it;
-            }
-            else
-            {
-                std::cout << "Removing dead object!\n";
-                it = observers_.erase(it);
-            }
-        }
-    }
-};
+#include "observer.hpp"
 
 class ConcreteObserver1 : public Observer
 {
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "observer.hpp"
+#include "seqlock.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct GadgetInfo
+    {
+        int id;
+        char name[28];
+    };
+
+    struct Wide
+    {
+        int64_t values[8];
+    };
+}
+
+TEST_CASE("Seqlocked")
+{
+    SECTION("load & store")
+    {
+        Seqlocked<GadgetInfo> info{GadgetInfo{1, "ipad"}};
+        REQUIRE(info.load().id == 1);
+
+        info.store(GadgetInfo{2, "mp3 player"});
+        REQUIRE(info.load().id == 2);
+        REQUIRE(std::string(info.load().name) == "mp3 player");
+        REQUIRE(info.version() == 1);
+    }
+
+    SECTION("readers never see torn values")
+    {
+        Seqlocked<Wide> wide;
+        std::atomic<bool> done{false};
+        std::atomic<int> torn_reads{0};
+
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < 2; ++i)
+            threads.emplace_back([&] {
+                for (int n = 1; n <= 10'000; ++n)
+                {
+                    Wide w;
+                    std::fill(std::begin(w.values), std::end(w.values), n);
+                    wide.store(w);
+                }
+            });
+
+        std::jthread reader{[&] {
+            while (!done)
+            {
+                Wide w = wide.load();
+                if (!std::all_of(std::begin(w.values), std::end(w.values), [&](auto v) { return v == w.values[0]; }))
+                    ++torn_reads;
+            }
+        }};
+
+        for (auto& t : threads)
+            t.join();
+        done = true;
+        reader.join();
+
+        REQUIRE(torn_reads == 0);
+        REQUIRE(wide.version() == 20'000);
+    }
+}
+
+TEST_CASE("ConcurrentSubject - state read from other threads")
+{
+    ConcurrentSubject s;
+    std::atomic<bool> done{false};
+    std::atomic<bool> went_back{false};
+
+    std::jthread reader{[&] {
+        int last = 0;
+        while (!done)
+        {
+            int current = s.state();
+            if (current < last)
+                went_back = true;
+            last = current;
+        }
+    }};
+
+    for (int i = 1; i <= 1'000; ++i)
+        s.set_state(i);
+    done = true;
+    reader.join();
+
+    REQUIRE_FALSE(went_back);
+    REQUIRE(s.state() == 1'000);
+}
+
+namespace
+{
+    template <typename TState>
+    double reads_per_second(TState& state, unsigned no_of_readers)
+    {
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> total_reads{0};
+
+        std::jthread writer{[&] {
+            for (int i = 0; !done; ++i)
+            {
+                state.store(GadgetInfo{i, "gadget"});
+                std::this_thread::sleep_for(1ms);
+            }
+        }};
+
+        std::vector<std::jthread> readers;
+        for (unsigned r = 0; r < no_of_readers; ++r)
+            readers.emplace_back([&] {
+                uint64_t reads = 0;
+                int checksum = 0;
+                while (!done)
+                {
+                    checksum += state.load().id;
+                    ++reads;
+                }
+                total_reads += reads + (checksum == -1);
+            });
+
+        const auto duration = 200ms;
+        std::this_thread::sleep_for(duration);
+        done = true;
+        readers.clear();
+
+        return total_reads / std::chrono::duration<double>(duration).count();
+    }
+
+    class MutexProtected
+    {
+        mutable std::mutex mtx_;
+        GadgetInfo value_{};
+
+    public:
+        GadgetInfo load() const
+        {
+            std::lock_guard lk{mtx_};
+            return value_;
+        }
+
+        void store(const GadgetInfo& value)
+        {
+            std::lock_guard lk{mtx_};
+            value_ = value;
+        }
+    };
+}
+
+TEST_CASE("Seqlocked - reader throughput with writer at 1 kHz", "[.benchmark]")
+{
+    const unsigned max_readers = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned readers = 1; readers <= max_readers; readers *= 2)
+    {
+        Seqlocked<GadgetInfo> seqlocked;
+        MutexProtected mutex_protected;
+
+        std::cout << "readers: " << readers
+                  << " | Seqlocked: " << reads_per_second(seqlocked, readers) / 1e6 << " M reads/s"
+                  << " | std::mutex: " << reads_per_second(mutex_protected, readers) / 1e6 << " M reads/s\n";
+    }
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "observer.hpp"
+#include "state_history.hpp"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("StateHistory")
+{
+    const StateHistory::TimePoint t0{};
+
+    StateHistory history(1'000, 16);
+    for (int i = 0; i < 100; ++i)
+        history.append(t0 + i * 10ms + (i % 3) * 1us, (i % 2 == 0) ? i : -i);
+
+    REQUIRE(history.size() == 100);
+
+    SECTION("range query")
+    {
+        auto entries = history.range(t0 + 200ms, t0 + 250ms);
+
+        REQUIRE(entries.size() == 5);
+        REQUIRE(entries.front() == StateHistory::Entry{t0 + 200ms + 2us, 20});
+        REQUIRE(entries.back() == StateHistory::Entry{t0 + 240ms, 24});
+    }
+
+    SECTION("replay from cursor")
+    {
+        std::vector<int> states;
+        auto cursor = history.replay(StateHistory::Cursor{97}, [&](const StateHistory::Entry& e) { states.push_back(e.state); });
+
+        REQUIRE(states == std::vector{-97, 98, -99});
+        REQUIRE(cursor == history.end());
+
+        history.append(t0 + 1s, 7);
+        states.clear();
+        history.replay(cursor, [&](const StateHistory::Entry& e) { states.push_back(e.state); });
+
+        REQUIRE(states == std::vector{7});
+    }
+
+    SECTION("compact encoding")
+    {
+        REQUIRE(history.memory_usage() < 100 * sizeof(StateHistory::Entry));
+    }
+
+    SECTION("bounded")
+    {
+        StateHistory bounded(32, 16);
+        for (int i = 0; i < 100; ++i)
+            bounded.append(t0 + i * 1ms, i);
+
+        REQUIRE(bounded.size() == 32);
+        REQUIRE(bounded.begin().position == 68);
+
+        std::vector<int> states;
+        bounded.replay(StateHistory::Cursor{0}, [&](const StateHistory::Entry& e) { states.push_back(e.state); });
+        REQUIRE(states.size() == 32);
+        REQUIRE(states.front() == 68);
+        REQUIRE(states.back() == 99);
+
+        auto entries = bounded.range(t0, t0 + 1s);
+        REQUIRE(entries.size() == 32);
+        REQUIRE(entries.front().state == 68);
+    }
+
+    SECTION("overflow drops only the oldest entry")
+    {
+        StateHistory bounded(100);
+        for (int i = 0; i < 101; ++i)
+            bounded.append(t0 + i * 1ms, i);
+
+        REQUIRE(bounded.size() == 100);
+        REQUIRE(bounded.begin().position == 1);
+        REQUIRE(bounded.range(t0, t0 + 1s).front().state == 1);
+
+        bounded.append(t0 + 1s, 101);
+        REQUIRE(bounded.size() == 100);
+        REQUIRE(bounded.range(t0, t0 + 2s).front().state == 2);
+    }
+}
+
+TEST_CASE("Subject with history")
+{
+    Subject s;
+    REQUIRE(s.history() == nullptr);
+
+    s.enable_history(100);
+    s.set_state(1);
+    s.set_state(1);
+    s.set_state(2);
+
+    std::vector<int> states;
+    s.history()->replay(s.history()->begin(), [&](const StateHistory::Entry& e) { states.push_back(e.state); });
+
+    REQUIRE(states == std::vector{1, 2});
+
+    SECTION("overflow keeps the newest entries")
+    {
+        for (int i = 3; i <= 101; ++i)
+            s.set_state(i);
+
+        REQUIRE(s.history()->size() == 100);
+    }
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "observer.hpp"
+#include "triple_buffer.hpp"
+
+namespace
+{
+    struct Frame
+    {
+        int64_t values[16];
+    };
+}
+
+TEST_CASE("TripleBuffer")
+{
+    SECTION("consumer reads latest value")
+    {
+        TripleBuffer<int> buffer{0};
+        REQUIRE(buffer.read() == 0);
+        REQUIRE_FALSE(buffer.update());
+
+        buffer.write(1);
+        buffer.write(2);
+        buffer.write(3);
+
+        REQUIRE(buffer.update());
+        REQUIRE(buffer.read() == 3);
+        REQUIRE_FALSE(buffer.update());
+    }
+
+    SECTION("no tearing between threads")
+    {
+        TripleBuffer<Frame> buffer;
+        std::atomic<bool> done{false};
+        bool torn = false;
+        int64_t last = 0;
+        bool went_back = false;
+
+        std::jthread consumer{[&] {
+            while (!done)
+            {
+                const Frame& frame = buffer.read();
+                if (!std::all_of(std::begin(frame.values), std::end(frame.values), [&](auto v) { return v == frame.values[0]; }))
+                    torn = true;
+                if (frame.values[0] < last)
+                    went_back = true;
+                last = frame.values[0];
+            }
+        }};
+
+        for (int64_t n = 1; n <= 100'000; ++n)
+        {
+            Frame& frame = buffer.write_buffer();
+            std::fill(std::begin(frame.values), std::end(frame.values), n);
+            buffer.publish();
+        }
+        done = true;
+        consumer.join();
+
+        REQUIRE_FALSE(torn);
+        REQUIRE_FALSE(went_back);
+        REQUIRE(buffer.read().values[0] == 100'000);
+    }
+}
+
+TEST_CASE("LatestStateChannel subscribed to Subject")
+{
+    Subject s;
+    auto channel = LatestStateChannel<>::subscribe(s);
+
+    REQUIRE(channel->latest() == 0);
+    REQUIRE_FALSE(channel->poll());
+
+    s.set_state(1);
+    s.set_state(2);
+
+    REQUIRE(channel->poll() == 2);
+    REQUIRE_FALSE(channel->poll());
+    REQUIRE(channel->latest() == 2);
+
+    SECTION("subject is moved")
+    {
+        std::optional<Subject> moved{std::move(s)};
+        s.set_state(5); // moved-from subject has no observers
+        moved->set_state(3);
+
+        REQUIRE(channel->poll() == 3);
+    }
+}
+
+TEST_CASE("state_of_event")
+{
+    REQUIRE(state_of_event(state_changed_event(-42)) == -42);
+    REQUIRE_FALSE(state_of_event("Changed state on: 1x"));
+    REQUIRE_FALSE(state_of_event("other event"));
+}
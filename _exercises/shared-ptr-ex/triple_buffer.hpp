@@ -0,0 +1,115 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "observer.hpp"
+
+// Wait-free single producer/single consumer "latest value" channel
+// - producer writes into its back buffer and swaps it with the middle one
+// - consumer swaps its front buffer with the middle one only when a fresh value was published
+// - neither side ever waits and the consumer never sees a partially written value
+template <typename T>
+class TripleBuffer
+{
+    static constexpr uint8_t index_mask = 0b011;
+    static constexpr uint8_t fresh_bit = 0b100;
+
+    std::array<T, 3> buffers_{};
+    alignas(64) std::atomic<uint8_t> middle_{2};
+    alignas(64) uint8_t back_ = 0;  // owned by producer
+    alignas(64) uint8_t front_ = 1; // owned by consumer
+
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& initial_value)
+        : buffers_{initial_value, initial_value, initial_value}
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // producer side
+    T& write_buffer()
+    {
+        return buffers_[back_];
+    }
+
+    void publish()
+    {
+        const uint8_t previous = middle_.exchange(back_ | fresh_bit, std::memory_order_acq_rel);
+        back_ = previous & index_mask;
+    }
+
+    void write(const T& value)
+    {
+        write_buffer() = value;
+        publish();
+    }
+
+    // consumer side - returns true if a fresh value was taken
+    bool update()
+    {
+        if ((middle_.load(std::memory_order_relaxed) & fresh_bit) == 0)
+            return false;
+
+        const uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & index_mask;
+        return true;
+    }
+
+    const T& read()
+    {
+        update();
+        return buffers_[front_];
+    }
+};
+
+// Adapter that feeds a TripleBuffer with the latest state of a subject
+// - producer: set_state() on the subject's thread, consumer: render thread calling latest() or poll()
+// - state is taken from the notification - the channel does not refer to the subject, which may be moved
+template <typename TSubject = Subject>
+class LatestStateChannel : public Observer
+{
+    TripleBuffer<int> buffer_;
+
+public:
+    explicit LatestStateChannel(const TSubject& subject)
+        : buffer_{subject.state()}
+    {
+    }
+
+    static std::shared_ptr<LatestStateChannel> subscribe(TSubject& subject)
+    {
+        auto channel = std::make_shared<LatestStateChannel>(subject);
+        subject.register_observer(channel);
+        return channel;
+    }
+
+    void update(const std::string& event_args) override
+    {
+        if (std::optional<int> state = state_of_event(event_args))
+            buffer_.write(*state);
+    }
+
+    int latest()
+    {
+        return buffer_.read();
+    }
+
+    // value published since the previous call
+    std::optional<int> poll()
+    {
+        if (buffer_.update())
+            return buffer_.read();
+        return std::nullopt;
+    }
+};
+
+#endif // TRIPLE_BUFFER_HPP
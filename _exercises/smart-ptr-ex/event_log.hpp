@@ -0,0 +1,346 @@
+#ifndef EVENT_LOG_HPP_
+#define EVENT_LOG_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h> // min/max macros are disabled by NOMINMAX set in CMakeLists.txt
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary event log stored in a memory-mapped ring file (little-endian):
+//   EventLogHeader | EventRecord[capacity]
+// - the event at position pos is stored in record pos % capacity - old events are overwritten
+// - writers reserve positions with an atomic increment of head and publish records with their sequence
+//   (pos + 1) like a seqlock, so appending is lock-free and readers skip records being written
+// - a writer claims its record with a CAS from the sequence of the previous lap (pos + 1 - capacity);
+//   when a writer laps a slower one (more than capacity appends in flight) its event is dropped and counted
+//   instead of waiting, so a record never mixes payloads of two events and append() stays lock-free
+// - words of the file are accessed through std::atomic_ref - concurrent writes and reads are not a data race
+namespace EventLogFormat
+{
+    static_assert(std::endian::native == std::endian::little, "event logs are little-endian");
+    static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+
+    constexpr char magic[4] = {'E', 'V', 'L', 'G'};
+    constexpr uint32_t version = 1;
+
+    // sequence of a record being written
+    constexpr uint64_t writing = ~uint64_t{0};
+
+    enum class EventKind : uint32_t
+    {
+        play = 1,
+        destroy = 2
+    };
+
+    inline const char* to_string(EventKind kind)
+    {
+        switch (kind)
+        {
+        case EventKind::play:
+            return "play";
+        case EventKind::destroy:
+            return "destroy";
+        }
+        return "unknown";
+    }
+
+    struct EventLogHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t capacity; // power of 2
+        uint64_t head;     // number of reserved positions
+        uint64_t dropped;  // number of events dropped by lapping writers
+        uint64_t reserved[4];
+    };
+
+    struct EventRecord
+    {
+        uint64_t sequence;  // pos + 1 when published, writing while being written, 0 before the first write
+        uint64_t timestamp; // ns since epoch of std::chrono::system_clock
+        EventKind kind;
+        int32_t gadget_id;
+        uint32_t thread;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(EventLogHeader) == 64 && sizeof(EventRecord) == 32);
+
+    // read-write (writer) or read-only (reader) shared memory mapping of the whole file
+    class MappedFile
+    {
+        char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#endif
+
+    public:
+        // size == 0 - existing file is mapped read-only, otherwise the file is created with size bytes
+        MappedFile(const std::string& path, size_t size)
+            : size_{size}
+        {
+            const bool writable = size != 0;
+#ifdef _WIN32
+            file_ = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                nullptr, writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER file_size;
+            file_size.QuadPart = static_cast<LONGLONG>(size);
+            if (file_ == INVALID_HANDLE_VALUE || (writable && (!SetFilePointerEx(file_, file_size, nullptr, FILE_BEGIN) || !SetEndOfFile(file_)))
+                || !GetFileSizeEx(file_, &file_size))
+            {
+                close();
+                throw std::runtime_error("Can not open event log: " + path);
+            }
+            size_ = static_cast<size_t>(file_size.QuadPart);
+            if (size_ == 0)
+                return;
+            mapping_ = CreateFileMappingA(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr
+                || (data_ = static_cast<char*>(MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0))) == nullptr)
+            {
+                close();
+                throw std::runtime_error("Can not map event log: " + path);
+            }
+#else
+            const int fd = writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (fd < 0 || (writable && ::ftruncate(fd, static_cast<off_t>(size)) != 0) || ::fstat(fd, &info) != 0)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+                throw std::runtime_error("Can not open event log: " + path);
+            }
+
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_ > 0)
+            {
+                void* data = ::mmap(nullptr, size_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Can not map event log: " + path);
+                }
+                data_ = static_cast<char*>(data);
+            }
+            ::close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            close();
+        }
+
+        char* data() const
+        {
+            return data_;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        void close() noexcept
+        {
+#ifdef _WIN32
+            if (data_)
+                UnmapViewOfFile(data_);
+            if (mapping_)
+                CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                CloseHandle(file_);
+#else
+            if (data_)
+                ::munmap(data_, size_);
+#endif
+            data_ = nullptr;
+        }
+    };
+
+    // small id of the calling thread - threads are numbered in order of their first event
+    inline uint32_t this_thread_index()
+    {
+        static std::atomic<uint32_t> next_index{0};
+        thread_local const uint32_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    inline std::atomic_ref<uint64_t> word(uint64_t& value)
+    {
+        return std::atomic_ref<uint64_t>{value};
+    }
+}
+
+// Writer of an event log - append() may be called concurrently from many threads
+class EventLog
+{
+    EventLogFormat::MappedFile file_;
+    EventLogFormat::EventLogHeader* header_;
+    EventLogFormat::EventRecord* records_;
+    uint64_t mask_;
+
+public:
+    // creates (or truncates) the file - capacity is rounded up to a power of 2
+    EventLog(const std::string& path, uint64_t capacity)
+        : file_{path, sizeof(EventLogFormat::EventLogHeader) + std::bit_ceil(std::max<uint64_t>(capacity, 1)) * sizeof(EventLogFormat::EventRecord)}
+        , header_{reinterpret_cast<EventLogFormat::EventLogHeader*>(file_.data())}
+        , records_{reinterpret_cast<EventLogFormat::EventRecord*>(file_.data() + sizeof(EventLogFormat::EventLogHeader))}
+        , mask_{std::bit_ceil(std::max<uint64_t>(capacity, 1)) - 1}
+    {
+        std::memcpy(header_->magic, EventLogFormat::magic, sizeof(EventLogFormat::magic));
+        header_->version = EventLogFormat::version;
+        header_->capacity = mask_ + 1;
+    }
+
+    uint64_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    // number of events appended so far
+    uint64_t size() const
+    {
+        return EventLogFormat::word(header_->head).load(std::memory_order_relaxed);
+    }
+
+    // number of events dropped because their record was still being written by a lapped writer
+    uint64_t dropped() const
+    {
+        return EventLogFormat::word(header_->dropped).load(std::memory_order_relaxed);
+    }
+
+    // returns false when the event is dropped (see dropped())
+    bool append(EventLogFormat::EventKind kind, int32_t gadget_id)
+    {
+        const uint64_t timestamp
+            = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        const uint64_t pos = EventLogFormat::word(header_->head).fetch_add(1, std::memory_order_relaxed);
+        auto& record = records_[pos & mask_];
+
+        uint64_t payload[2];
+        EventLogFormat::EventRecord values{0, 0, kind, gadget_id, EventLogFormat::this_thread_index(), 0};
+        std::memcpy(payload, &values.kind, sizeof(payload));
+        auto* words = reinterpret_cast<uint64_t*>(&record);
+
+        // sequence of the previous event stored in the record - anything else means the writer of an older lap
+        // has not published yet (it may be preempted or dead), waiting for it would make append() blocking
+        uint64_t expected = pos > mask_ ? pos - mask_ : 0;
+        if (!EventLogFormat::word(record.sequence).compare_exchange_strong(expected, EventLogFormat::writing, std::memory_order_relaxed))
+        {
+            EventLogFormat::word(header_->dropped).fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        EventLogFormat::word(record.timestamp).store(timestamp, std::memory_order_relaxed);
+        EventLogFormat::word(words[2]).store(payload[0], std::memory_order_relaxed);
+        EventLogFormat::word(words[3]).store(payload[1], std::memory_order_relaxed);
+        EventLogFormat::word(record.sequence).store(pos + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// Reader of an event log - may read a log that is being written
+class EventLogReader
+{
+    EventLogFormat::MappedFile file_;
+    const EventLogFormat::EventLogHeader* header_;
+    const EventLogFormat::EventRecord* records_;
+
+public:
+    explicit EventLogReader(const std::string& path)
+        : file_{path, 0}
+        , header_{reinterpret_cast<const EventLogFormat::EventLogHeader*>(file_.data())}
+        , records_{reinterpret_cast<const EventLogFormat::EventRecord*>(file_.data() + sizeof(EventLogFormat::EventLogHeader))}
+    {
+        if (file_.size() < sizeof(EventLogFormat::EventLogHeader) || std::memcmp(header_->magic, EventLogFormat::magic, sizeof(EventLogFormat::magic)) != 0)
+            throw std::runtime_error("Not an event log: " + path);
+        if (header_->version != EventLogFormat::version)
+            throw std::runtime_error("Unsupported version of event log: " + std::to_string(header_->version));
+        if (!std::has_single_bit(header_->capacity)
+            || header_->capacity != (file_.size() - sizeof(EventLogFormat::EventLogHeader)) / sizeof(EventLogFormat::EventRecord))
+            throw std::runtime_error("Corrupted event log - invalid size");
+    }
+
+    uint64_t capacity() const
+    {
+        return header_->capacity;
+    }
+
+    // number of events appended so far - events before size() - capacity() are overwritten
+    uint64_t size() const
+    {
+        return load(header_->head, std::memory_order_acquire);
+    }
+
+    // number of events dropped by lapping writers
+    uint64_t dropped() const
+    {
+        return load(header_->dropped, std::memory_order_relaxed);
+    }
+
+    // calls f(const EventRecord&) for events still in the ring in order of positions
+    // - returns the number of skipped events (overwritten, being written or dropped)
+    template <typename F>
+    uint64_t for_each(F&& f) const
+    {
+        const uint64_t head = size();
+        const uint64_t first = head > capacity() ? head - capacity() : 0;
+        uint64_t skipped = first;
+
+        for (uint64_t pos = first; pos < head; ++pos)
+        {
+            const auto& record = records_[pos & (capacity() - 1)];
+            EventLogFormat::EventRecord copy;
+
+            if (load(record.sequence, std::memory_order_acquire) != pos + 1)
+            {
+                ++skipped;
+                continue;
+            }
+            const uint64_t* words = reinterpret_cast<const uint64_t*>(&record);
+            const uint64_t payload[2] = {load(words[2], std::memory_order_relaxed), load(words[3], std::memory_order_relaxed)};
+            copy.timestamp = load(record.timestamp, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (load(record.sequence, std::memory_order_relaxed) != pos + 1)
+            {
+                ++skipped;
+                continue;
+            }
+
+            copy.sequence = pos + 1;
+            std::memcpy(&copy.kind, payload, sizeof(payload));
+            f(copy);
+        }
+
+        return skipped;
+    }
+
+private:
+    // the mapping is read-only, atomic_ref is used only for loads
+    static uint64_t load(const uint64_t& value, std::memory_order order)
+    {
+        return EventLogFormat::word(const_cast<uint64_t&>(value)).load(order);
+    }
+};
+
+#endif /*EVENT_LOG_HPP_*/
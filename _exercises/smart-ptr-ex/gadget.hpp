@@ -0,0 +1,63 @@
+#ifndef GADGET_HPP_
+#define GADGET_HPP_
+
+#include <expected>
+#include <iostream>
+#include <stdexcept>
+
+enum class GadgetError
+{
+    crashed
+};
+
+class Gadget
+{
+public:
+    Gadget(int id = 0)
+        : id_{id}
+    {
+        std::cout << "Constructing Gadget(" << id_ << ")\n";
+    }
+
+    Gadget(const Gadget&) = delete;
+    Gadget& operator=(const Gadget&) = delete;
+
+    ~Gadget()
+    {
+        std::cout << "Destroying ~Gadget(" << id_ << ")\n";
+    }
+
+    int id() const
+    {
+        return id_;
+    }
+
+    void set_id(int id)
+    {
+        id_ = id;
+    }
+
+    void use()
+    {
+        std::cout << "Using a gadget with id: " << id() << '\n';
+    }
+
+    void unsafe()
+    {
+        std::cout << "Using a gadget with id: " << id() << " - Ups... It crashed..." << std::endl;
+        throw std::runtime_error("ERROR");
+    }
+
+    // unsafe() without exceptions - the error is returned to the caller
+    // - the message is not flushed, callers handling many errors are not slowed down by I/O
+    [[nodiscard]] std::expected<void, GadgetError> try_unsafe()
+    {
+        std::cout << "Using a gadget with id: " << id() << " - Ups... It crashed...\n";
+        return std::unexpected{GadgetError::crashed};
+    }
+
+private:
+    int id_;
+};
+
+#endif /*GADGET_HPP_*/
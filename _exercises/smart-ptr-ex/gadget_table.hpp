@@ -0,0 +1,251 @@
+#ifndef GADGET_TABLE_HPP_
+#define GADGET_TABLE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GADGET_KERNELS_SSE2 1
+#endif
+
+// Kernels over arrays of ids
+// - SSE2 kernels process 4 ids per instruction, scalar loops handle the tail (and targets without SSE2)
+namespace GadgetKernels
+{
+    inline void fill(int* ids, size_t count, int value)
+    {
+        size_t i = 0;
+#ifdef GADGET_KERNELS_SSE2
+        const __m128i v = _mm_set1_epi32(value);
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ids + i), v);
+#endif
+        for (; i < count; ++i)
+            ids[i] = value;
+    }
+
+    // ids[i] = first + i
+    inline void iota(int* ids, size_t count, int first)
+    {
+        size_t i = 0;
+#ifdef GADGET_KERNELS_SSE2
+        const __m128i step = _mm_set1_epi32(4);
+        __m128i v = _mm_add_epi32(_mm_set1_epi32(first), _mm_setr_epi32(0, 1, 2, 3));
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ids + i), v);
+            v = _mm_add_epi32(v, step);
+        }
+#endif
+        for (; i < count; ++i)
+            ids[i] = static_cast<int>(first + static_cast<unsigned>(i));
+    }
+
+    // number of ids in [lo, hi]
+    inline size_t count_range(const int* ids, size_t count, int lo, int hi)
+    {
+        size_t i = 0;
+        size_t result = 0;
+#ifdef GADGET_KERNELS_SSE2
+        // lanes of inside masks are -1 - subtracting them counts 4 lanes at once
+        const __m128i l = _mm_set1_epi32(lo);
+        const __m128i h = _mm_set1_epi32(hi);
+        const __m128i all = _mm_set1_epi32(-1);
+        while (i + 4 <= count)
+        {
+            __m128i counters = _mm_setzero_si128();
+            // lanes count at most 2^31 matches before they are summed
+            for (size_t end = std::min(count & ~size_t{3}, i + (size_t{1} << 31)); i < end; i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+                const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(v, l), _mm_cmpgt_epi32(v, h));
+                counters = _mm_sub_epi32(counters, _mm_xor_si128(outside, all));
+            }
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counters);
+            result += size_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+        }
+#endif
+        for (; i < count; ++i)
+            result += (ids[i] >= lo && ids[i] <= hi) ? 1 : 0;
+        return result;
+    }
+
+    // calls f(index) for ids in [lo, hi] in increasing order of indexes while f returns true
+    template <typename F>
+    void scan_range(const int* ids, size_t count, int lo, int hi, F&& f)
+    {
+        size_t i = 0;
+#ifdef GADGET_KERNELS_SSE2
+        const __m128i l = _mm_set1_epi32(lo);
+        const __m128i h = _mm_set1_epi32(hi);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i + 4));
+            // outside = id < lo || id > hi
+            const __m128i outside_a = _mm_or_si128(_mm_cmplt_epi32(a, l), _mm_cmpgt_epi32(a, h));
+            const __m128i outside_b = _mm_or_si128(_mm_cmplt_epi32(b, l), _mm_cmpgt_epi32(b, h));
+            unsigned mask = ~static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(outside_a))
+                                | _mm_movemask_ps(_mm_castsi128_ps(outside_b)) << 4)
+                & 0xFF;
+            while (mask != 0)
+            {
+                if (!f(i + static_cast<size_t>(std::countr_zero(mask))))
+                    return;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            if (ids[i] >= lo && ids[i] <= hi && !f(i))
+                return;
+    }
+}
+
+class GadgetTable;
+
+// Lightweight reference to a gadget stored in GadgetTable - valid while the table is not resized
+class GadgetRef
+{
+    GadgetTable* table_;
+    size_t index_;
+
+public:
+    GadgetRef(GadgetTable& table, size_t index)
+        : table_{&table}
+        , index_{index}
+    {
+    }
+
+    size_t index() const
+    {
+        return index_;
+    }
+
+    int id() const;
+    void set_id(int id);
+    void use() const;
+};
+
+// Gadgets in structure-of-arrays form - every field of Gadget is a separate contiguous array
+// (Gadget has only id), so bulk operations touch only the fields they need and run in SIMD
+// - gadgets are constructed and destroyed in bulk, without per-gadget logging
+class GadgetTable
+{
+    std::vector<int> ids_;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    GadgetTable() = default;
+
+    // gadgets with ids 0, 1, ..., size - 1 (as LegacyCode::create_many_gadgets)
+    explicit GadgetTable(size_t size)
+        : ids_(size)
+    {
+        GadgetKernels::iota(ids_.data(), ids_.size(), 0);
+    }
+
+    size_t size() const
+    {
+        return ids_.size();
+    }
+
+    bool empty() const
+    {
+        return ids_.empty();
+    }
+
+    void reserve(size_t size)
+    {
+        ids_.reserve(size);
+    }
+
+    // appends a gadget - returns its index
+    size_t add(int id)
+    {
+        ids_.push_back(id);
+        return ids_.size() - 1;
+    }
+
+    GadgetRef operator[](size_t index)
+    {
+        assert(index < ids_.size());
+        return GadgetRef{*this, index};
+    }
+
+    int id(size_t index) const
+    {
+        return ids_[index];
+    }
+
+    void set_id(size_t index, int id)
+    {
+        ids_[index] = id;
+    }
+
+    const int* ids() const
+    {
+        return ids_.data();
+    }
+
+    // bulk reset_value - all gadgets get id n
+    void reset_value(int n)
+    {
+        GadgetKernels::fill(ids_.data(), ids_.size(), n);
+    }
+
+    // gadgets get consecutive ids first, first + 1, ...
+    void reset_values(int first)
+    {
+        GadgetKernels::iota(ids_.data(), ids_.size(), first);
+    }
+
+    // index of the first gadget with id or npos
+    size_t find(int id) const
+    {
+        size_t result = npos;
+        GadgetKernels::scan_range(ids_.data(), ids_.size(), id, id, [&result](size_t index) {
+            result = index;
+            return false;
+        });
+        return result;
+    }
+
+    // indexes of gadgets with ids in [lo, hi]
+    std::vector<size_t> filter(int lo, int hi) const
+    {
+        std::vector<size_t> result;
+        GadgetKernels::scan_range(ids_.data(), ids_.size(), lo, hi, [&result](size_t index) { result.push_back(index); return true; });
+        return result;
+    }
+
+    size_t count(int lo, int hi) const
+    {
+        return GadgetKernels::count_range(ids_.data(), ids_.size(), lo, hi);
+    }
+};
+
+inline int GadgetRef::id() const
+{
+    return table_->id(index_);
+}
+
+inline void GadgetRef::set_id(int id)
+{
+    table_->set_id(index_, id);
+}
+
+inline void GadgetRef::use() const
+{
+    std::cout << "Using a gadget with id: " << id() << '\n';
+}
+
+#endif /*GADGET_TABLE_HPP_*/
@@ -1,52 +1,19 @@
+#include <chrono>
+#include <cstring>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <streambuf>
 #include <vector>
 
-using namespace std;
-
-class Gadget
-{
-public:
-    Gadget(int id = 0)
-        : id_{id}
-    {
-        std::cout << "Constructing Gadget(" << id_ << ")\n";
-    }
-
-    Gadget(const Gadget&) = delete;
-    Gadget& operator=(const Gadget&) = delete;
-
-    ~Gadget()
-    {
-        std::cout << "Destroying ~Gadget(" << id_ << ")\n";
-    }
-
-    int id() const
-    {
-        return id_;
-    }
-
-    void set_id(int id)
-    {
-        id_ = id;
-    }
-
-    void use()
-    {
-        std::cout << "Using a gadget with id: " << id() << '\n';
-    }
-
-    void unsafe()
-    {
-        std::cout << "Using a gadget with id: " << id() << " - Ups... It crashed..." << std::endl;
-        throw std::runtime_error("ERROR");
-    }
+#include "event_log.hpp"
+#include "gadget.hpp"
+#include "gadget_table.hpp"
 
-private:
-    int id_;
-};
+using namespace std;
 
 namespace LegacyCode
 {
@@ -81,6 +48,7 @@ class Player
 {
     Gadget* gadget_;
     std::ostream* logger_;
+    EventLog* events_ = nullptr;
 
     Player(const Player&);
     Player& operator=(const Player&);
@@ -94,10 +62,19 @@ public:
             throw std::invalid_argument("Gadget can not be null");
     }
 
+    // events are written to the binary log instead of formatted text
+    Player(Gadget* g, EventLog& events)
+        : Player(g)
+    {
+        events_ = &events;
+    }
+
     ~Player()
     {
         if (logger_)
             *logger_ << "Destroing a gadget: " << gadget_->id() << std::endl;
+        if (events_)
+            events_->append(EventLogFormat::EventKind::destroy, gadget_->id());
 
         delete gadget_;
     }
@@ -106,6 +83,8 @@ public:
     {
         if (logger_)
             *logger_ << "Player is using a gadget: " << gadget_->id() << std::endl;
+        if (events_)
+            events_->append(EventLogFormat::EventKind::play, gadget_->id());
 
         gadget_->use();
     }
@@ -165,8 +144,246 @@ void unsafe3() // TODO: modernize using smart pointers
         delete *it;
 }
 
-int main() try
+//////////////////////////////////////////////
+// GadgetTable vs. array of Gadget objects
+
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+template <typename F>
+void measure(const char* name, F&& f)
 {
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = f();
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    cout << name << ": " << elapsed.count() << " ms (result: " << result << ")" << endl;
+}
+
+void benchmark_gadget_table(unsigned int size)
+{
+    cout << "\n--- " << size << " gadgets ---\n";
+
+    NullBuffer null_buffer;
+    auto* cout_buffer = cout.rdbuf(&null_buffer); // logging of Gadget goes nowhere, but is still formatted
+
+    Gadget* legacy = nullptr;
+    const auto start = std::chrono::steady_clock::now();
+    legacy = LegacyCode::create_many_gadgets(size);
+    const auto legacy_creation = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    const auto reset_start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < size; ++i)
+        reset_value(legacy[i], 42);
+    const auto legacy_reset = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reset_start);
+
+    cout.rdbuf(cout_buffer);
+    cout << "LegacyCode::create_many_gadgets: " << legacy_creation.count() << " ms\n";
+    cout << "reset_value() for every gadget: " << legacy_reset.count() << " ms\n";
+
+    // array of objects without logging - the same data layout as GadgetTable for Gadget with only id
+    measure("Gadget[] - set_id(i) for every gadget", [&] {
+        for (unsigned int i = 0; i < size; ++i)
+            legacy[i].set_id(static_cast<int>(i));
+        return legacy[size - 1].id();
+    });
+
+    measure("Gadget[] - count of ids in range", [&] {
+        size_t result = 0;
+        for (unsigned int i = 0; i < size; ++i)
+            result += (legacy[i].id() >= 1000 && legacy[i].id() <= static_cast<int>(size / 2)) ? 1 : 0;
+        return result;
+    });
+
+    measure("Gadget[] - filter of ids in range", [&] {
+        std::vector<size_t> result;
+        for (unsigned int i = 0; i < size; ++i)
+            if (legacy[i].id() >= static_cast<int>(size / 2) && legacy[i].id() <= static_cast<int>(size / 2) + 10)
+                result.push_back(i);
+        return result.size();
+    });
+
+    cout.rdbuf(&null_buffer);
+    delete[] legacy;
+    cout.rdbuf(cout_buffer);
+
+    GadgetTable table;
+    measure("GadgetTable - bulk construction", [&] {
+        table = GadgetTable{size};
+        return table.size();
+    });
+
+    measure("GadgetTable - bulk reset_value", [&] {
+        table.reset_value(42);
+        return table.id(size - 1);
+    });
+
+    measure("GadgetTable - bulk reset_values", [&] {
+        table.reset_values(0);
+        return table.id(size - 1);
+    });
+
+    measure("GadgetTable - count of ids in range", [&] { return table.count(1000, static_cast<int>(size / 2)); });
+
+    measure("GadgetTable - filter of ids in range", [&] { return table.filter(static_cast<int>(size / 2), static_cast<int>(size / 2) + 10).size(); });
+
+    measure("GadgetTable - find", [&] { return table.find(static_cast<int>(size - 1)); });
+
+    GadgetRef gadget = table[size / 2];
+    gadget.set_id(-1);
+    cout << "GadgetRef - id of gadget " << gadget.index() << ": " << table.id(size / 2) << endl;
+}
+
+//////////////////////////////////////////////
+// errors of Gadget - exceptions vs. std::expected
+
+// gadgets that crash are reported and skipped - no exception is thrown
+void use_gadgets_without_exceptions()
+{
+    Gadget gadgets[3] = {10, 11, 12};
+
+    for (auto& g : gadgets)
+    {
+        if (g.id() % 2 == 0)
+            g.use();
+        else if (auto result = g.try_unsafe(); !result)
+            cout << "Gadget(" << g.id() << ") is skipped\n";
+    }
+}
+
+// every failure_percent-th of 100 gadgets crashes - unsafe() throws, try_unsafe() returns an error
+// - logging of Gadget goes to NullBuffer, so the timed loops do no I/O
+void benchmark_gadget_errors(unsigned int count, unsigned int failure_percent)
+{
+    cout << "\n--- " << count << " gadgets, " << failure_percent << "% failures ---\n";
+
+    std::vector<char> fails(count);
+    for (unsigned int i = 0; i < count; ++i)
+        fails[i] = (i * 37 % 100) < failure_percent; // failures are spread over the whole range
+
+    NullBuffer null_buffer;
+    auto* cout_buffer = cout.rdbuf(&null_buffer);
+    Gadget g{1};
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t thrown = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        try
+        {
+            if (fails[i])
+                g.unsafe();
+            else
+                g.use();
+        }
+        catch (const std::runtime_error&)
+        {
+            ++thrown;
+        }
+    }
+    const auto exceptions = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+    const auto expected_start = std::chrono::steady_clock::now();
+    size_t returned = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!fails[i])
+            g.use();
+        else if (auto result = g.try_unsafe(); !result)
+            ++returned;
+    }
+    const auto expected = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - expected_start);
+
+    cout.rdbuf(cout_buffer);
+    cout << "unsafe() & catch: " << exceptions.count() / count << " ns per gadget (" << thrown << " errors)\n";
+    cout << "try_unsafe(): " << expected.count() / count << " ns per gadget (" << returned << " errors)\n";
+}
+
+//////////////////////////////////////////////
+// text logging of Player vs. binary event log
+
+// Player writes its events to the binary log, the log is read back as event-log-decoder does
+void play_with_event_log()
+{
+    const auto path = (std::filesystem::temp_directory_path() / "player_events.bin").string();
+    EventLog events{path, 1024};
+    {
+        Player p(create_gadget(7), events);
+        p.play();
+        p.play();
+    }
+
+    EventLogReader reader{path};
+    reader.for_each([](const EventLogFormat::EventRecord& record) {
+        cout << "Event " << record.sequence << ": " << EventLogFormat::to_string(record.kind) << " gadget " << record.gadget_id << "\n";
+    });
+}
+
+void benchmark_event_log(unsigned int count)
+{
+    cout << "\n--- " << count << " events ---\n";
+
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto per_event = [count](auto start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+
+    // both logs are timed after the same warm-up of count events (file pages are allocated, caches are warm)
+    {
+        std::ofstream logger{directory / "player_events.txt"};
+        for (unsigned int i = 0; i < count; ++i)
+            logger << "Player is using a gadget: " << static_cast<int>(i) << std::endl;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < count; ++i)
+            logger << "Player is using a gadget: " << static_cast<int>(i) << std::endl;
+        cout << "text log with std::endl: " << per_event(start) << " ns per event\n";
+    }
+
+    {
+        EventLog events{(directory / "player_events.bin").string(), count};
+        for (unsigned int i = 0; i < count; ++i)
+            events.append(EventLogFormat::EventKind::play, static_cast<int>(i));
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < count; ++i)
+            events.append(EventLogFormat::EventKind::play, static_cast<int>(i));
+        cout << "binary event log: " << per_event(start) << " ns per event\n";
+    }
+
+    cout << "durability: both logs survive a crash of the process - std::endl passes every line to the OS,\n"
+         << "  the binary log writes to a shared mapping; neither is synced to disk (no fsync / msync)\n";
+
+    cout << "decode with: event-log-decoder " << (directory / "player_events.bin").string() << endl;
+}
+
+int main(int argc, char* argv[]) try
+{
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0)
+    {
+        benchmark_gadget_table(10'000'000);
+        benchmark_event_log(1'000'000);
+        for (unsigned int failure_percent : {0, 1, 10, 50})
+            benchmark_gadget_errors(1'000'000, failure_percent);
+        return 0;
+    }
+
+    if (argc > 2 && std::strcmp(argv[1], "--benchmark-errors") == 0)
+    {
+        benchmark_gadget_errors(1'000'000, static_cast<unsigned int>(std::stoul(argv[2])));
+        return 0;
+    }
+
     try
     {
         unsafe1();
@@ -177,6 +394,10 @@ int main() try
     {
         cout << "Exception caught: " << e.what() << endl;
     }
+
+    use_gadgets_without_exceptions();
+
+    play_with_event_log();
 }
 catch (const exception& e)
 {
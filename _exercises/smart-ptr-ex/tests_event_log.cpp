@@ -0,0 +1,119 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "event_log.hpp"
+
+using EventLogFormat::EventKind;
+using EventLogFormat::EventRecord;
+
+namespace
+{
+    std::string temp_path(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}
+
+TEST_CASE("EventLog - append & read")
+{
+    const std::string path = temp_path("tests_event_log.bin");
+
+    EventLog log{path, 4};
+    REQUIRE(log.capacity() == 4);
+
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(log.append(i % 2 ? EventKind::destroy : EventKind::play, i));
+
+    EventLogReader reader{path};
+    REQUIRE(reader.size() == 10);
+
+    std::vector<int32_t> ids;
+    const uint64_t skipped = reader.for_each([&](const EventRecord& record) {
+        REQUIRE(record.sequence == static_cast<uint64_t>(record.gadget_id) + 1);
+        REQUIRE(record.kind == (record.gadget_id % 2 ? EventKind::destroy : EventKind::play));
+        ids.push_back(record.gadget_id);
+    });
+
+    REQUIRE(skipped == 6); // overwritten
+    REQUIRE(ids == std::vector<int32_t>{6, 7, 8, 9});
+    REQUIRE(reader.dropped() == 0);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("EventLog - concurrent writers lapping a small ring and a reader")
+{
+    constexpr int no_of_writers = 8;
+    constexpr int events_per_writer = 50'000;
+    const std::string path = temp_path("tests_event_log_concurrent.bin");
+
+    EventLog log{path, 4};
+    EventLogReader reader{path};
+
+    std::vector<uint32_t> writer_threads(no_of_writers);
+    std::atomic<int> finished_writers{0};
+    std::atomic<uint64_t> written{0};
+
+    // gadget id encodes the writer - a record mixing two events has a thread that does not match its gadget id
+    auto check = [&](const EventRecord& record) {
+        const int writer = record.gadget_id / events_per_writer;
+        REQUIRE(writer >= 0);
+        REQUIRE(writer < no_of_writers);
+        REQUIRE(record.thread == writer_threads[writer]);
+        REQUIRE(record.kind == (record.gadget_id % 2 ? EventKind::destroy : EventKind::play));
+        REQUIRE(record.timestamp != 0);
+    };
+
+    std::vector<std::thread> writers;
+    std::atomic<int> started_writers{0};
+    for (int w = 0; w < no_of_writers; ++w)
+        writers.emplace_back([&, w] {
+            writer_threads[w] = EventLogFormat::this_thread_index();
+            ++started_writers;
+            while (started_writers != no_of_writers)
+                std::this_thread::yield();
+
+            uint64_t count = 0;
+            for (int i = 0; i < events_per_writer; ++i)
+            {
+                const int id = w * events_per_writer + i;
+                count += log.append(id % 2 ? EventKind::destroy : EventKind::play, id) ? 1 : 0;
+            }
+            written += count;
+            ++finished_writers;
+        });
+
+    while (started_writers != no_of_writers)
+        std::this_thread::yield();
+
+    uint64_t no_of_reads = 0;
+    while (finished_writers != no_of_writers)
+    {
+        reader.for_each([&](const EventRecord& record) {
+            check(record);
+            ++no_of_reads;
+        });
+    }
+
+    for (auto& writer : writers)
+        writer.join();
+
+    REQUIRE(reader.size() == uint64_t{no_of_writers} * events_per_writer);
+    REQUIRE(written + reader.dropped() == reader.size());
+
+    uint64_t published = 0;
+    reader.for_each([&](const EventRecord& record) {
+        check(record);
+        ++published;
+    });
+    REQUIRE(published <= log.capacity());
+    REQUIRE(published + reader.dropped() >= log.capacity()); // a record is empty only when its last writer was dropped
+
+    std::remove(path.c_str());
+}
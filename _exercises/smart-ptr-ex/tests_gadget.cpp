@@ -0,0 +1,23 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "gadget.hpp"
+
+TEST_CASE("Gadget - errors")
+{
+    Gadget g{42};
+
+    SECTION("unsafe throws")
+    {
+        REQUIRE_THROWS_AS(g.unsafe(), std::runtime_error);
+    }
+
+    SECTION("try_unsafe returns an error")
+    {
+        auto result = g.try_unsafe();
+
+        REQUIRE_FALSE(result.has_value());
+        REQUIRE(result.error() == GadgetError::crashed);
+    }
+
+    REQUIRE(g.id() == 42);
+}
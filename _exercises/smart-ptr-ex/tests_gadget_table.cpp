@@ -0,0 +1,118 @@
+#include <climits>
+#include <cstddef>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "gadget_table.hpp"
+
+namespace
+{
+    constexpr int bounds[][2] = {{-100, 100}, {0, 0}, {INT_MIN, INT_MIN}, {INT_MAX, INT_MAX}, {INT_MIN, 0}, {0, INT_MAX}, {INT_MIN, INT_MAX}, {5, -5}};
+
+    // ids around the limits of int, so that every bound above matches some of them
+    std::vector<int> random_ids(size_t count, std::mt19937& rnd)
+    {
+        const int values[] = {INT_MIN, INT_MIN + 1, -100, -1, 0, 1, 100, INT_MAX - 1, INT_MAX};
+        std::vector<int> ids(count);
+        for (auto& id : ids)
+            id = values[rnd() % std::size(values)];
+        return ids;
+    }
+
+    std::vector<size_t> scalar_filter(const std::vector<int>& ids, int lo, int hi)
+    {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < ids.size(); ++i)
+            if (ids[i] >= lo && ids[i] <= hi)
+                result.push_back(i);
+        return result;
+    }
+}
+
+TEST_CASE("GadgetKernels - same results as scalar loops")
+{
+    std::mt19937 rnd{42};
+
+    SECTION("fill")
+    {
+        for (size_t size = 0; size <= 17; ++size)
+            for (int value : {INT_MIN, -1, 0, INT_MAX})
+            {
+                std::vector<int> ids(size + 1, 42);
+                GadgetKernels::fill(ids.data(), size, value);
+
+                for (size_t i = 0; i < size; ++i)
+                    REQUIRE(ids[i] == value);
+                REQUIRE(ids[size] == 42);
+            }
+    }
+
+    SECTION("iota wraps around as unsigned arithmetic")
+    {
+        for (size_t size = 0; size <= 17; ++size)
+            for (int first : {INT_MIN, -5, 0, INT_MAX - 7, INT_MAX})
+            {
+                std::vector<int> ids(size + 1, 42);
+                GadgetKernels::iota(ids.data(), size, first);
+
+                for (size_t i = 0; i < size; ++i)
+                    REQUIRE(ids[i] == static_cast<int>(static_cast<unsigned>(first) + static_cast<unsigned>(i)));
+                REQUIRE(ids[size] == 42);
+            }
+    }
+
+    SECTION("count_range & scan_range")
+    {
+        for (size_t size = 0; size <= 17; ++size)
+        {
+            const std::vector<int> ids = random_ids(size, rnd);
+
+            for (const auto& [lo, hi] : bounds)
+            {
+                const std::vector<size_t> expected = scalar_filter(ids, lo, hi);
+
+                REQUIRE(GadgetKernels::count_range(ids.data(), ids.size(), lo, hi) == expected.size());
+
+                std::vector<size_t> scanned;
+                GadgetKernels::scan_range(ids.data(), ids.size(), lo, hi, [&](size_t index) {
+                    scanned.push_back(index);
+                    return true;
+                });
+                REQUIRE(scanned == expected);
+
+                // scan stops when f returns false
+                std::vector<size_t> first;
+                GadgetKernels::scan_range(ids.data(), ids.size(), lo, hi, [&](size_t index) {
+                    first.push_back(index);
+                    return false;
+                });
+                REQUIRE(first.size() == (expected.empty() ? 0 : 1));
+                if (!expected.empty())
+                    REQUIRE(first.front() == expected.front());
+            }
+        }
+    }
+}
+
+TEST_CASE("GadgetTable")
+{
+    GadgetTable table{20};
+
+    REQUIRE(table.size() == 20);
+    REQUIRE(table.id(19) == 19);
+    REQUIRE(table.count(5, 9) == 5);
+    REQUIRE(table.filter(17, 100) == std::vector<size_t>{17, 18, 19});
+    REQUIRE(table.find(13) == 13);
+    REQUIRE(table.find(20) == GadgetTable::npos);
+
+    table[3].set_id(INT_MAX);
+    REQUIRE(table.find(INT_MAX) == 3);
+
+    table.reset_values(INT_MAX - 1);
+    REQUIRE(table.id(0) == INT_MAX - 1);
+    REQUIRE(table.id(2) == INT_MIN);
+
+    table.reset_value(INT_MIN);
+    REQUIRE(table.count(INT_MIN, INT_MIN) == 20);
+}
@@ -0,0 +1,42 @@
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+
+#include "event_log.hpp"
+
+// Renders records of a binary event log to text:
+//   <UTC date & time with ns> thread <index> <kind> gadget <id>
+int main(int argc, char* argv[]) try
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <event log file>\n";
+        return 2;
+    }
+
+    EventLogReader reader{argv[1]};
+
+    const uint64_t skipped = reader.for_each([](const EventLogFormat::EventRecord& record) {
+        using namespace std::chrono;
+
+        const sys_time<nanoseconds> time{nanoseconds{record.timestamp}};
+        const auto day = floor<days>(time);
+        const year_month_day date{day};
+        const hh_mm_ss<nanoseconds> clock{time - day};
+
+        std::printf("%04d-%02u-%02u %02ld:%02ld:%02ld.%09ld thread %u %s gadget %d\n", static_cast<int>(date.year()),
+            static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()), static_cast<long>(clock.hours().count()),
+            static_cast<long>(clock.minutes().count()), static_cast<long>(clock.seconds().count()), static_cast<long>(clock.subseconds().count()),
+            record.thread, EventLogFormat::to_string(record.kind), record.gadget_id);
+    });
+
+    std::fprintf(stderr, "%llu events, %llu overwritten or incomplete (%llu dropped by lapping writers)\n",
+        static_cast<unsigned long long>(reader.size()), static_cast<unsigned long long>(skipped),
+        static_cast<unsigned long long>(reader.dropped()));
+}
+catch (const std::exception& e)
+{
+    std::cerr << "Error: " << e.what() << '\n';
+    return 1;
+}
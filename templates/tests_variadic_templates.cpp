@@ -1,9 +1,15 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cctype>
+#include <charconv>
+#include <expected>
 #include <iostream>
 #include <memory>
 #include <algorithm>
 #include <tuple>
 #include <numeric>
+#include <random>
+#include <string_view>
 #include <variant>
 
 namespace VariadicTemplates
@@ -270,6 +276,22 @@ struct Data
     }
 }
 
+// non-throwing parse_data - accepts the same inputs as std::stoi (leading whitespace, optional sign, trailing chars)
+[[nodiscard]] std::expected<Data, std::errc> try_parse_data(std::string_view str)
+{
+    size_t pos = 0;
+    while (pos < str.size() && std::isspace(static_cast<unsigned char>(str[pos])))
+        ++pos;
+    if (pos < str.size() && str[pos] == '+' && (pos + 1 == str.size() || str[pos + 1] != '-'))
+        ++pos;
+
+    Data data;
+    auto [end, ec] = std::from_chars(str.data() + pos, str.data() + str.size(), data.value);
+    if (ec != std::errc{})
+        return std::unexpected{std::errc::invalid_argument};
+    return data;
+}
+
 struct F
 {
     void operator()(int x) { std::cout << "x: " << x << "\n"; }
@@ -303,6 +325,30 @@ decltype(auto) process_result(TVariant&& result, THandlers&&... handlers)
     return std::visit(visitor, result);
 } 
 
+template <typename T>
+constexpr bool is_expected_v = false;
+
+template <typename T, typename E>
+constexpr bool is_expected_v<std::expected<T, E>> = true;
+
+// handlers are called with the value or the error - the same handlers as for variants
+template <typename TExpected, typename... THandlers>
+    requires is_expected_v<std::remove_cvref_t<TExpected>>
+decltype(auto) process_result(TExpected&& result, THandlers&&... handlers)
+{
+    auto visitor = overload{
+        std::forward<THandlers>(handlers)...
+    };
+
+    if (!result.has_value())
+        return visitor(std::forward<TExpected>(result).error());
+
+    if constexpr (std::is_void_v<typename std::remove_cvref_t<TExpected>::value_type>)
+        return visitor();
+    else
+        return visitor(*std::forward<TExpected>(result));
+}
+
 TEST_CASE("using variants in return type")
 {
     process_result(parse_data("x"), 
@@ -311,3 +357,60 @@ TEST_CASE("using variants in return type")
     );
 }
 
+TEST_CASE("using expected in return type")
+{
+    for (const std::string input : {"42", "-7", "  13", "+5", "12abc", "2147483647", "-2147483648"})
+    {
+        auto parsed = try_parse_data(input);
+        REQUIRE(parsed.has_value());
+        REQUIRE(parsed->value == std::get<Data>(parse_data(input)).value);
+    }
+
+    for (const std::string input : {"", "x", "abc12", "+-5", "-", "+", "2147483648", "99999999999999999999"})
+    {
+        REQUIRE(std::holds_alternative<std::errc>(parse_data(input)));
+        REQUIRE(try_parse_data(input) == std::unexpected{std::errc::invalid_argument});
+    }
+
+    const auto handlers = overload{
+        [](const Data& d) { return d.value; },
+        [](std::errc) { return -1; }
+    };
+
+    REQUIRE(process_result(try_parse_data("665"), handlers) == 665);
+    REQUIRE(process_result(try_parse_data("x"), handlers) == -1);
+    REQUIRE(process_result(parse_data("x"), handlers) == -1);
+
+    std::expected<void, std::errc> done{};
+    REQUIRE(process_result(done, [] { return 0; }, [](std::errc) { return -1; }) == 0);
+}
+
+TEST_CASE("parse_data vs. try_parse_data - failure rates", "[.benchmark]")
+{
+    std::mt19937 rnd{42};
+
+    for (int failure_percent : {0, 1, 10, 50})
+    {
+        std::vector<std::string> inputs(10'000);
+        for (auto& input : inputs)
+            input = (static_cast<int>(rnd() % 100) < failure_percent) ? "n/a" : std::to_string(rnd() % 1'000'000);
+
+        const auto suffix = " - " + std::to_string(failure_percent) + "% failures";
+
+        BENCHMARK("parse_data (exceptions)" + suffix)
+        {
+            long sum = 0;
+            for (const auto& input : inputs)
+                sum += process_result(parse_data(input), [](const Data& d) { return d.value; }, [](std::errc) { return -1; });
+            return sum;
+        };
+
+        BENCHMARK("try_parse_data (expected)" + suffix)
+        {
+            long sum = 0;
+            for (const auto& input : inputs)
+                sum += process_result(try_parse_data(input), [](const Data& d) { return d.value; }, [](std::errc) { return -1; });
+            return sum;
+        };
+    }
+}